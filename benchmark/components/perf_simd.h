@@ -38,7 +38,8 @@
 #include "perf_base.h"
 #include "vec_buffers.h"
 
-#ifdef QUADIRON_USE_SIMD
+// The kernels are benchmarked directly, hence not in a dispatch build.
+#if defined(QUADIRON_USE_SIMD) && !defined(QUADIRON_SIMD_DISPATCH)
 
 #include "simd.h"
 #include "simd/simd.h"
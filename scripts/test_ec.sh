@@ -185,3 +185,13 @@ do
     do_test all ${fec_type} ${word_size} 9 5 "1 3 5 7 8" ""
     do_test all ${fec_type} ${word_size} 9 5 "" "0 1 2 3 4"
 done
+
+# Vertical streams overlapping I/O and encoding
+for i in rs-fnt_1 rs-fnt_2 rs-fnt-sys_1 rs-fnt-sys_2
+do
+    fec_type=$(echo $i|cut -d_ -f1)
+    word_size=$(echo $i|cut -d_ -f2)
+
+    do_test all ${fec_type} ${word_size} 3 3 "0 1" "0" "-P"
+    do_test all ${fec_type} ${word_size} 9 5 "1 3 5" "1 3" "-P"
+done
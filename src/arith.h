@@ -57,6 +57,12 @@ T exp(T base, T exponent);
 template <typename T>
 T exp_mod(T base, T exponent, T modulus);
 template <typename T>
+bool is_shoup_modulus(T modulus);
+template <typename T>
+T shoup_precompute(T a, T modulus);
+template <typename T>
+T mul_shoup(T a, T a_shoup, T b, T modulus);
+template <typename T>
 bool is_power_of_2(int x);
 template <typename T>
 T ceil2(int x);
@@ -192,6 +198,78 @@ T exp_mod(T base, T exponent, T modulus)
     return result;
 }
 
+/** Check if Shoup's multiplication applies to a modulus.
+ *
+ * @param[in] modulus the modulus `m`
+ * @return true if \f$m < 2^{w-1}\f$, `w` being the bit width of `T`
+ */
+template <typename T>
+bool is_shoup_modulus(T modulus)
+{
+    return (modulus >> (sizeof(T) * CHAR_BIT - 1)) == 0;
+}
+
+/** Precompute the quotient of a constant for Shoup's multiplication.
+ *
+ * @param[in] a the constant, lower than the modulus
+ * @param[in] modulus the modulus `m`
+ * @return the value of \f$\lfloor a 2^w / m \rfloor\f$, `w` being the bit
+ * width of `T`
+ *
+ * @pre `is_shoup_modulus(modulus)`
+ */
+template <typename T>
+T shoup_precompute(T a, T modulus)
+{
+    const DoubleSizeVal<T> shifted = DoubleSizeVal<T>(a)
+                                     << (sizeof(T) * CHAR_BIT);
+    return static_cast<T>(shifted / modulus);
+}
+
+/** Compute a modular multiplication by a constant with Shoup's method.
+ *
+ * The quotient of `a * b` by the modulus is estimated from the precomputed
+ * quotient of `a`, up to one unit: no division is performed.
+ *
+ * @param[in] a the constant, lower than the modulus
+ * @param[in] a_shoup the precomputed quotient of `a`, see `shoup_precompute`
+ * @param[in] b the multiplier, lower than the modulus
+ * @param[in] modulus the modulus `m`
+ * @return the value of \f$a b \mod m\f$
+ *
+ * @pre `is_shoup_modulus(modulus)`
+ */
+template <typename T>
+T mul_shoup(T a, T a_shoup, T b, T modulus)
+{
+    const T quotient = static_cast<T>(
+        (DoubleSizeVal<T>(a_shoup) * b) >> (sizeof(T) * CHAR_BIT));
+    // Exact value in [0, 2m), hence it fits in `T`.
+    const T res = static_cast<T>(
+        DoubleSizeVal<T>(a) * b - DoubleSizeVal<T>(quotient) * modulus);
+    return res >= modulus ? res - modulus : res;
+}
+
+// There is no wider type to compute Shoup's multiplication on 128 bits.
+template <>
+inline bool is_shoup_modulus(__uint128_t)
+{
+    return false;
+}
+
+template <>
+inline __uint128_t shoup_precompute(__uint128_t, __uint128_t)
+{
+    throw LogicError("Shoup's multiplication not supported on 128 bits");
+}
+
+template <>
+inline __uint128_t
+mul_shoup(__uint128_t, __uint128_t, __uint128_t, __uint128_t)
+{
+    throw LogicError("Shoup's multiplication not supported on 128 bits");
+}
+
 /** Test if `n` is a power of two.
  *
  * @param[in] n a number
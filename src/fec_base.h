@@ -34,27 +34,25 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <sys/time.h>
 
 #include "fec_context.h"
+#include "fec_stats.h"
 #include "fft_base.h"
 #include "gf_base.h"
 #include "misc.h"
 #include "property.h"
+#include "simd_dispatch.h"
+#include "thread_pool.h"
 #include "vec_buffers.h"
 #include "vec_cast.h"
 #include "vec_poly.h"
 #include "vec_slice.h"
 #include "vec_vector.h"
 
-#ifdef QUADIRON_USE_SIMD
-
-#include "simd.h"
-
-#endif // #ifdef QUADIRON_USE_SIMD
-
 namespace quadiron {
 
 /** Forward Error Correction code implementations. */
@@ -211,6 +209,31 @@ class FecCode {
         std::vector<bool>& wanted_idxs,
         size_t block_size_bytes);
 
+    void encode_stripes_vertical(
+        const std::vector<std::vector<uint8_t*>>& data_bufs,
+        const std::vector<std::vector<uint8_t*>>& parities_bufs,
+        std::vector<std::vector<Properties>>& parities_props,
+        const std::vector<bool>& wanted_idxs,
+        size_t block_size_bytes);
+
+    void update_parities(
+        unsigned fragment_index,
+        const uint8_t* old_data,
+        const uint8_t* new_data,
+        const std::vector<uint8_t*>& parities_bufs,
+        std::vector<Properties>& parities_props,
+        size_t block_size_bytes);
+
+    bool repair_block_vertical(
+        unsigned fragment_index,
+        const std::vector<uint8_t*>& data_bufs,
+        const std::vector<uint8_t*>& parities_bufs,
+        const std::vector<Properties>& parities_props,
+        const std::vector<int>& missing_idxs,
+        uint8_t* output,
+        Properties& output_props,
+        size_t block_size_bytes);
+
     bool decode_blocks_vertical(
         std::vector<uint8_t*>& data_bufs,
         std::vector<uint8_t*>& parities_bufs,
@@ -219,6 +242,107 @@ class FecCode {
         std::vector<bool>& wanted_idxs,
         size_t block_size_bytes);
 
+    /** Set the number of threads used to encode and decode blocks.
+     *
+     * With more than one thread, `encode_blocks_vertical` and
+     * `decode_blocks_vertical` split each block into ranges of packets that
+     * are processed concurrently. Codes that cannot run concurrently keep
+     * processing blocks on the calling thread.
+     *
+     * @param n_threads number of threads, the calling thread included
+     */
+    void set_n_threads(unsigned n_threads);
+
+    /** Return the number of threads used to encode and decode blocks. */
+    unsigned get_n_threads() const
+    {
+        return pool ? pool->size() + 1 : 1;
+    }
+
+    /** Overlap the I/O and the processing of the vertical stream functions.
+     *
+     * When enabled, `encode_streams_vertical` and `decode_streams_vertical`
+     * keep two chunks in flight: a helper thread writes the previous chunk and
+     * reads the next one while the current one is processed. Streams are only
+     * accessed by that thread during the calls.
+     *
+     * @param enabled whether to overlap I/O and processing
+     */
+    void set_stream_pipelining(bool enabled)
+    {
+        if (enabled == get_stream_pipelining()) {
+            return;
+        }
+        io_pool = enabled ? std::make_unique<ThreadPool>(1) : nullptr;
+    }
+
+    /** Return whether the vertical stream functions overlap I/O and
+     * processing.
+     */
+    bool get_stream_pipelining() const
+    {
+        return io_pool != nullptr;
+    }
+
+    /** Set the number of erasure patterns whose decoding contexts are kept
+     * by `decode_blocks_vertical`.
+     *
+     * Decoding blocks with a pattern again then reuses its decoding contexts
+     * and their buffers instead of building them.
+     *
+     * @param capacity maximum number of patterns kept (0 disables the cache)
+     */
+    void set_decode_cache_capacity(size_t capacity)
+    {
+        dec_contexts.set_capacity(capacity);
+    }
+
+    size_t get_decode_cache_capacity() const
+    {
+        return dec_contexts.get_capacity();
+    }
+
+    /** Return the number of block decodings that reused cached contexts. */
+    uint64_t get_decode_cache_hits() const
+    {
+        return dec_contexts.get_hits();
+    }
+
+    /** Return the number of block decodings that had to build contexts. */
+    uint64_t get_decode_cache_misses() const
+    {
+        return dec_contexts.get_misses();
+    }
+
+    /** Enable or disable the per-stage statistics of the codec.
+     *
+     * When enabled, the cycles spent in each stage of the encoding and the
+     * decoding (see `Stage`) are accumulated until `reset_stage_stats` is
+     * called. Disabling them discards the counters.
+     *
+     * @param enabled whether to collect per-stage statistics
+     */
+    void set_stage_stats(bool enabled)
+    {
+        if (enabled == (stage_stats != nullptr)) {
+            return;
+        }
+        stage_stats = enabled ? std::make_unique<StageStats>() : nullptr;
+    }
+
+    /** Return the per-stage statistics, or `nullptr` if they are disabled. */
+    const StageStats* get_stage_stats() const
+    {
+        return stage_stats.get();
+    }
+
+    void reset_stage_stats()
+    {
+        if (stage_stats) {
+            stage_stats->reset();
+        }
+    }
+
     const gf::Field<T>& get_gf()
     {
         return *gf;
@@ -250,6 +374,31 @@ class FecCode {
     std::unique_ptr<vec::Vector<T>> r_powers = nullptr;
     // buffers for intermediate symbols used for systematic FNT
     std::unique_ptr<vec::Buffers<T>> dec_inter_codeword;
+    // workers of the block encoding and decoding (none if single-threaded)
+    std::unique_ptr<ThreadPool> pool = nullptr;
+    // I/O thread of the pipelined stream functions (none if not pipelined)
+    std::unique_ptr<ThreadPool> io_pool = nullptr;
+    // decoding states of the last erasure patterns seen by the block decoding
+    DecodeContextCache<T> dec_contexts;
+    // per-stage statistics (none if disabled)
+    std::unique_ptr<StageStats> stage_stats = nullptr;
+
+    /// Number of chunks in flight in the vertical stream functions
+    static constexpr unsigned N_STREAM_SLOTS = 2;
+
+    /** Timing statistics collected over a range of packets */
+    struct RangeStats {
+        uint64_t cycles = 0;
+        uint64_t usec = 0;
+        uint64_t ops = 0;
+    };
+
+    // Scratch of the block encoding and decoding, one item per range of
+    // packets. It grows on demand and is kept across calls.
+    std::vector<std::unique_ptr<BlockBuffers<T>>> block_bufs;
+    std::vector<std::unique_ptr<Workspace<T>>> block_workspaces;
+    std::vector<std::vector<Properties>> ranges_props;
+    std::vector<RangeStats> ranges_stats;
 
     // pure abstract methods that will be defined in derived class
     virtual void check_params() = 0;
@@ -291,6 +440,114 @@ class FecCode {
         DecodeContext<T>& context,
         vec::Buffers<T>& output,
         vec::Buffers<T>& words);
+
+    /** Whether separate workspaces make the Buffers-based `encode` and
+     * `decode` safe to run concurrently on distinct packets.
+     */
+    virtual bool is_parallel_safe() const
+    {
+        return false;
+    }
+
+    /** Whether `update_parities` is supported, i.e. the encoding of packets
+     * is linear and their properties only mark the outputs equal to `card - 1`
+     * (see `OOR_MARK`).
+     */
+    virtual bool is_update_supported() const
+    {
+        return false;
+    }
+
+    /** Whether `repair_block_vertical` is supported, i.e. fragment `i` is the
+     * value at `r^i` of a polynomial of degree less than `n_data`, and
+     * properties only mark the values equal to `card - 1`.
+     */
+    virtual bool is_repair_supported() const
+    {
+        return false;
+    }
+
+    virtual std::unique_ptr<Workspace<T>> alloc_workspace();
+
+    /** Encode Buffers using the scratch memory of `workspace` */
+    virtual void encode_with_workspace(
+        Workspace<T>&,
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words)
+    {
+        encode(output, props, offset, words);
+    }
+
+    /** Prepare an encoding computing only the wanted outputs
+     *
+     * @param wanted_idxs wanted outputs (n_outputs entries)
+     * @param[out] plan codec-specific description of the wanted outputs,
+     * given to `encode_pruned`
+     *
+     * @return true if `encode_pruned` is faster than the full encoding
+     */
+    virtual bool prune_outputs(
+        const std::vector<bool>& /* wanted_idxs */,
+        std::vector<unsigned>& /* plan */) const
+    {
+        return false;
+    }
+
+    /** Encode Buffers computing only the outputs prepared by `prune_outputs`
+     *
+     * Other outputs are left undefined.
+     *
+     * @param workspace scratch memory, or nullptr to use the codec's own
+     * @param plan as returned by `prune_outputs`
+     */
+    virtual void encode_pruned(
+        Workspace<T>* /* workspace */,
+        vec::Buffers<T>& /* output */,
+        std::vector<Properties>& /* props */,
+        off_t /* offset */,
+        vec::Buffers<T>& /* words */,
+        const std::vector<unsigned>& /* plan */)
+    {
+        throw LogicError("FEC: pruned encoding is not supported");
+    }
+
+    /** Decode Buffers using the scratch memory of `workspace` */
+    void decode_with_workspace(
+        Workspace<T>& workspace,
+        DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words);
+
+  private:
+    void decode_with_inter_codeword(
+        vec::Buffers<T>* inter_codeword,
+        DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words);
+
+    void run_streams_vertical(
+        const std::function<size_t(unsigned)>& read_chunk,
+        const std::function<void(unsigned, off_t)>& process_chunk,
+        const std::function<void(unsigned, size_t)>& write_chunk);
+    void encode_range(
+        Workspace<T>* workspace,
+        BlockBuffers<T>& bufs,
+        const std::vector<uint8_t*>& data_bufs,
+        const std::vector<uint8_t*>& parities_bufs,
+        std::vector<Properties>& props,
+        const std::vector<bool>& wanted_idxs,
+        size_t begin,
+        size_t end,
+        RangeStats& stats);
+    size_t get_n_ranges(size_t n_pkts) const;
+    void reserve_block_scratch(size_t n_ranges);
+    size_t get_range_begin(size_t range, size_t n_ranges, size_t n_pkts) const;
 };
 
 /// Create an encoder.
@@ -315,6 +572,81 @@ FecCode<T>::FecCode(
     this->buf_size = pkt_size * word_size;
 }
 
+template <typename T>
+void FecCode<T>::set_n_threads(unsigned n_threads)
+{
+    if (n_threads == get_n_threads()) {
+        return;
+    }
+    pool = nullptr;
+    if (n_threads > 1) {
+        pool = std::make_unique<ThreadPool>(n_threads - 1);
+    }
+}
+
+template <typename T>
+std::unique_ptr<Workspace<T>> FecCode<T>::alloc_workspace()
+{
+    std::unique_ptr<Workspace<T>> workspace = std::make_unique<Workspace<T>>();
+    if (dec_inter_codeword) {
+        workspace->dec_inter_codeword =
+            std::make_unique<vec::Buffers<T>>(this->n, pkt_size);
+    }
+    return workspace;
+}
+
+/** Return the number of packet ranges a block is split into
+ *
+ * It is also the number of tasks stripes are spread over, see
+ * `encode_stripes_vertical`.
+ *
+ * @param n_pkts number of packets in the block
+ */
+template <typename T>
+size_t FecCode<T>::get_n_ranges(size_t n_pkts) const
+{
+    if (!pool || !is_parallel_safe()) {
+        return 1;
+    }
+    return std::min<size_t>(get_n_threads(), n_pkts);
+}
+
+/** Make the block scratch cover `n_ranges` ranges of packets
+ *
+ * Workspaces and per-range properties are only needed by the parallel paths,
+ * hence they are only allocated for more than one range. Statistics of the
+ * ranges are reset.
+ */
+template <typename T>
+void FecCode<T>::reserve_block_scratch(size_t n_ranges)
+{
+    while (block_bufs.size() < n_ranges) {
+        block_bufs.push_back(std::make_unique<BlockBuffers<T>>(
+            n_data, get_n_outputs(), pkt_size, buf_size));
+    }
+    if (n_ranges > 1) {
+        while (block_workspaces.size() < n_ranges) {
+            block_workspaces.push_back(alloc_workspace());
+        }
+        if (ranges_props.size() < n_ranges) {
+            ranges_props.resize(n_ranges, std::vector<Properties>(n_outputs));
+        }
+    }
+    ranges_stats.assign(n_ranges, RangeStats());
+}
+
+/** Return the offset (in words) at which a range of packets begins
+ *
+ * Packets are evenly spread over the ranges, so that no range is longer than
+ * another by more than one packet.
+ */
+template <typename T>
+size_t
+FecCode<T>::get_range_begin(size_t range, size_t n_ranges, size_t n_pkts) const
+{
+    return (range * n_pkts / n_ranges) * pkt_size;
+}
+
 template <typename T>
 inline bool FecCode<T>::readw(T* ptr, std::istream* stream)
 {
@@ -474,32 +806,36 @@ void FecCode<T>::encode_streams_vertical(
         props.clear();
     }
 
-    bool cont = true;
-    off_t offset = 0;
-
-    // vector of buffers storing data read from chunk
-    vec::Buffers<char> words_char(n_data, buf_size);
-    const std::vector<char*> words_mem_char = words_char.get_mem();
     // vector of buffers storing data that are performed in encoding, i.e. FFT
     vec::Buffers<T> words(n_data, pkt_size);
-    const std::vector<T*> words_mem_T = words.get_mem();
+    const std::vector<T*>& words_mem_T = words.get_mem();
 
     int output_len = get_n_outputs();
 
     // vector of buffers storing data that are performed in encoding, i.e. FFT
     vec::Buffers<T> output(output_len, pkt_size);
-    const std::vector<T*> output_mem_T = output.get_mem();
-    // vector of buffers storing data in output chunk
-    vec::Buffers<char> output_char(output_len, buf_size);
-    const std::vector<char*> output_mem_char = output_char.get_mem();
+    const std::vector<T*>& output_mem_T = output.get_mem();
+
+    // vectors of buffers storing data read from chunk and data in output
+    // chunk, one per chunk in flight
+    std::unique_ptr<vec::Buffers<char>> words_char[N_STREAM_SLOTS];
+    std::unique_ptr<vec::Buffers<char>> output_char[N_STREAM_SLOTS];
+    for (unsigned slot = 0; slot < N_STREAM_SLOTS; ++slot) {
+        words_char[slot] =
+            std::make_unique<vec::Buffers<char>>(n_data, buf_size);
+        output_char[slot] =
+            std::make_unique<vec::Buffers<char>>(output_len, buf_size);
+    }
 
     reset_stats_enc();
 
-    // Number of bytes would be read from each input stream
-    // We suppose that these stream returns the same quantity of data.
-    size_t read_bytes = buf_size;
+    auto read_chunk = [&](unsigned slot) {
+        const std::vector<char*>& words_mem_char = words_char[slot]->get_mem();
+
+        // Number of bytes would be read from each input stream
+        // We suppose that these stream returns the same quantity of data.
+        size_t read_bytes = buf_size;
 
-    while (cont) {
         for (unsigned i = 0; i < n_data; i++) {
             if (!read_pkt(words_mem_char.at(i), *(input_data_bufs[i]))) {
                 read_bytes = input_data_bufs[i]->gcount();
@@ -508,18 +844,22 @@ void FecCode<T>::encode_streams_vertical(
                     words_mem_char.at(i) + read_bytes,
                     buf_size - read_bytes,
                     0);
-
-                cont = false;
             }
         }
-
-        if (read_bytes == 0) {
-            break;
+        return read_bytes;
+    };
+
+    auto encode_chunk = [&](unsigned slot, off_t offset) {
+        {
+            StageTimer timer(stage_stats.get(), Stage::PACK);
+            vec::pack<char, T>(
+                words_char[slot]->get_mem(),
+                words_mem_T,
+                n_data,
+                pkt_size,
+                word_size);
         }
 
-        vec::pack<char, T>(
-            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
-
         timeval t1 = tick();
         uint64_t start = hw_timer();
         encode(output, output_parities_props, offset, words);
@@ -530,13 +870,86 @@ void FecCode<T>::encode_streams_vertical(
         total_encode_cycles += (end - start) / buf_size;
         n_encode_ops++;
 
+        StageTimer timer(stage_stats.get(), Stage::UNPACK);
         vec::unpack<T, char>(
-            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
-
+            output_mem_T,
+            output_char[slot]->get_mem(),
+            output_len,
+            pkt_size,
+            word_size);
+    };
+
+    auto write_chunk = [&](unsigned slot, size_t bytes) {
         for (unsigned i = 0; i < n_outputs; i++) {
             write_pkt(
-                output_mem_char.at(i), *(output_parities_bufs[i]), read_bytes);
+                output_char[slot]->get(i), *(output_parities_bufs[i]), bytes);
         }
+    };
+
+    run_streams_vertical(read_chunk, encode_chunk, write_chunk);
+}
+
+/** Run the chunk loop of the vertical stream functions
+ *
+ * Chunks are read into, processed in and written from one of
+ * `N_STREAM_SLOTS` slots. While chunk `i` is processed, chunk `i - 1` is
+ * written and chunk `i + 1` is read, on the I/O thread if the stream functions
+ * are pipelined (see `set_stream_pipelining`).
+ *
+ * @param read_chunk read the next chunk into a slot and return its size in
+ * bytes. A chunk shorter than `buf_size` is the last one
+ * @param process_chunk process the chunk of a slot, given its offset in words
+ * @param write_chunk write a given number of bytes of the chunk of a slot
+ */
+template <typename T>
+void FecCode<T>::run_streams_vertical(
+    const std::function<size_t(unsigned)>& read_chunk,
+    const std::function<void(unsigned, off_t)>& process_chunk,
+    const std::function<void(unsigned, size_t)>& write_chunk)
+{
+    static_assert(N_STREAM_SLOTS == 2, "chunks alternate between two slots");
+
+    unsigned slot = 0;
+    size_t bytes = read_chunk(slot);
+    size_t prev_bytes = 0;
+    off_t offset = 0;
+
+    while (bytes > 0 || prev_bytes > 0) {
+        // The previous chunk and the next one share the other slot.
+        const unsigned other = slot ^ 1;
+        const bool is_last = bytes < buf_size;
+        size_t next_bytes = 0;
+
+        auto io = [&]() {
+            if (prev_bytes > 0) {
+                write_chunk(other, prev_bytes);
+            }
+            if (!is_last) {
+                next_bytes = read_chunk(other);
+            }
+        };
+        auto process = [&]() {
+            if (bytes > 0) {
+                process_chunk(slot, offset);
+            }
+        };
+
+        if (io_pool) {
+            io_pool->run(2, [&](size_t task) {
+                if (task == 0) {
+                    io();
+                } else {
+                    process();
+                }
+            });
+        } else {
+            process();
+            io();
+        }
+
+        prev_bytes = bytes;
+        bytes = next_bytes;
+        slot = other;
         offset += pkt_size;
     }
 }
@@ -901,9 +1314,6 @@ bool FecCode<T>::decode_streams_vertical(
     std::vector<Properties>& input_parities_props,
     std::vector<std::ostream*>& output_data_bufs)
 {
-    bool cont = true;
-    off_t offset = 0;
-
     unsigned fragment_index = 0;
     unsigned parity_index = 0;
     unsigned avail_data_nb = 0;
@@ -957,32 +1367,43 @@ bool FecCode<T>::decode_streams_vertical(
 
     decode_build();
 
-    // vector of buffers storing data read from chunk
-    vec::Buffers<char> words_char(n_data, buf_size);
-    const std::vector<char*> words_mem_char = words_char.get_mem();
     // vector of buffers storing data that are performed in encoding, i.e. FFT
     vec::Buffers<T> words(n_data, pkt_size);
-    const std::vector<T*> words_mem_T = words.get_mem();
+    const std::vector<T*>& words_mem_T = words.get_mem();
 
     int output_len = n_data;
 
     // vector of buffers storing data that are performed in decoding, i.e. FFT
     vec::Buffers<T> output(output_len, pkt_size);
-    const std::vector<T*> output_mem_T = output.get_mem();
-    // vector of buffers storing data in output chunk
-    vec::Buffers<char> output_char(output_len, buf_size);
-    const std::vector<char*> output_mem_char = output_char.get_mem();
+    const std::vector<T*>& output_mem_T = output.get_mem();
+
+    // vectors of buffers storing data read from chunk and data in output
+    // chunk, one per chunk in flight
+    std::unique_ptr<vec::Buffers<char>> words_char[N_STREAM_SLOTS];
+    std::unique_ptr<vec::Buffers<char>> output_char[N_STREAM_SLOTS];
+    for (unsigned slot = 0; slot < N_STREAM_SLOTS; ++slot) {
+        words_char[slot] =
+            std::make_unique<vec::Buffers<char>>(n_data, buf_size);
+        output_char[slot] =
+            std::make_unique<vec::Buffers<char>>(output_len, buf_size);
+    }
 
-    std::unique_ptr<DecodeContext<T>> context = init_context_dec(
-        fragments_ids, input_parities_props, pkt_size, &output);
+    std::unique_ptr<DecodeContext<T>> context;
+    {
+        StageTimer timer(stage_stats.get(), Stage::CONTEXT_BUILD);
+        context = init_context_dec(
+            fragments_ids, input_parities_props, pkt_size, &output);
+    }
 
     reset_stats_dec();
 
-    // Number of bytes would be read from each input stream
-    // We suppose that these stream returns the same quantity of data.
-    size_t read_bytes = buf_size;
+    auto read_chunk = [&](unsigned slot) {
+        const std::vector<char*>& words_mem_char = words_char[slot]->get_mem();
+
+        // Number of bytes would be read from each input stream
+        // We suppose that these stream returns the same quantity of data.
+        size_t read_bytes = buf_size;
 
-    while (cont) {
         if (type == FecType::SYSTEMATIC) {
             for (unsigned i = 0; i < avail_data_nb; i++) {
                 unsigned data_idx = fragments_ids.get(i);
@@ -994,8 +1415,6 @@ bool FecCode<T>::decode_streams_vertical(
                         words_mem_char.at(i) + read_bytes,
                         buf_size - read_bytes,
                         0);
-
-                    cont = false;
                 }
             }
         }
@@ -1010,18 +1429,22 @@ bool FecCode<T>::decode_streams_vertical(
                     words_mem_char.at(avail_data_nb + i) + read_bytes,
                     buf_size - read_bytes,
                     0);
-
-                cont = false;
             }
         }
-
-        if (read_bytes == 0) {
-            break;
+        return read_bytes;
+    };
+
+    auto decode_chunk = [&](unsigned slot, off_t offset) {
+        {
+            StageTimer timer(stage_stats.get(), Stage::PACK);
+            vec::pack<char, T>(
+                words_char[slot]->get_mem(),
+                words_mem_T,
+                n_data,
+                pkt_size,
+                word_size);
         }
 
-        vec::pack<char, T>(
-            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
-
         timeval t1 = tick();
         uint64_t start = hw_timer();
         decode(*context, output, input_parities_props, offset, words);
@@ -1032,19 +1455,145 @@ bool FecCode<T>::decode_streams_vertical(
         total_decode_cycles += (end - start) / word_size;
         n_decode_ops++;
 
+        StageTimer timer(stage_stats.get(), Stage::UNPACK);
         vec::unpack<T, char>(
-            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
-
+            output_mem_T,
+            output_char[slot]->get_mem(),
+            output_len,
+            pkt_size,
+            word_size);
+    };
+
+    auto write_chunk = [&](unsigned slot, size_t bytes) {
         for (unsigned i = 0; i < n_data; i++) {
             if (output_data_bufs[i] != nullptr) {
                 write_pkt(
-                    output_mem_char.at(i), *(output_data_bufs[i]), read_bytes);
+                    output_char[slot]->get(i), *(output_data_bufs[i]), bytes);
+            }
+        }
+    };
+
+    run_streams_vertical(read_chunk, decode_chunk, write_chunk);
+
+    return true;
+}
+
+/** Encode packets of blocks from `begin` to `end` (offsets in words)
+ *
+ * @param workspace scratch memory of the codec, or nullptr to use the one
+ * owned by the codec
+ * @param bufs staging buffers
+ * @param stats statistics of the range, updated
+ *
+ * See `encode_blocks_vertical` for the other parameters.
+ */
+template <typename T>
+void FecCode<T>::encode_range(
+    Workspace<T>* workspace,
+    BlockBuffers<T>& bufs,
+    const std::vector<uint8_t*>& data_bufs,
+    const std::vector<uint8_t*>& parities_bufs,
+    std::vector<Properties>& props,
+    const std::vector<bool>& wanted_idxs,
+    size_t begin,
+    size_t end,
+    RangeStats& stats)
+{
+    const int output_len = get_n_outputs();
+
+    // vector of buffers storing data read from chunk
+    const std::vector<uint8_t*>& words_mem_char = bufs.words_char.get_mem();
+    // vector of buffers storing data that are performed in encoding, i.e.
+    // FFT
+    vec::Buffers<T>& words = bufs.words;
+    const std::vector<T*>& words_mem_T = words.get_mem();
+
+    // vector of buffers storing data that are performed in encoding, i.e.
+    // FFT
+    vec::Buffers<T>& output = bufs.output;
+    const std::vector<T*>& output_mem_T = output.get_mem();
+    // vector of buffers storing data in output chunk
+    const std::vector<uint8_t*>& output_mem_char = bufs.output_char.get_mem();
+
+    // only the wanted outputs are computed when it is faster
+    std::vector<unsigned> plan;
+    const bool pruned = prune_outputs(wanted_idxs, plan);
+
+    size_t offset = begin;
+    while (offset < end) {
+        size_t remain_size = end - offset;
+        size_t copy_size = std::min(pkt_size, remain_size);
+        {
+            StageTimer timer(stage_stats.get(), Stage::COPY);
+            for (unsigned i = 0; i < n_data; i++) {
+                memcpy(
+                    reinterpret_cast<char*>(words_mem_char.at(i)),
+                    data_bufs[i] + offset * word_size,
+                    copy_size * word_size);
+            }
+
+            // Zero-out trailing part of data
+            if (copy_size < pkt_size) {
+                const size_t copy_bytes = copy_size * word_size;
+                const size_t trailing_bytes = buf_size - copy_bytes;
+                for (unsigned i = 0; i < n_data; i++) {
+                    memset(
+                        reinterpret_cast<char*>(words_mem_char.at(i))
+                            + copy_bytes,
+                        0,
+                        trailing_bytes);
+                }
+            }
+        }
+
+        {
+            StageTimer timer(stage_stats.get(), Stage::PACK);
+            vec::pack<uint8_t, T>(
+                words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+        }
+
+        timeval t1 = tick();
+        uint64_t start = hw_timer();
+        if (pruned) {
+            encode_pruned(workspace, output, props, offset, words, plan);
+        } else if (workspace) {
+            encode_with_workspace(*workspace, output, props, offset, words);
+        } else {
+            encode(output, props, offset, words);
+        }
+        uint64_t end_time = hw_timer();
+        uint64_t t2 = hrtime_usec(t1);
+
+        stats.usec += t2;
+        stats.cycles += (end_time - start) / (copy_size * word_size);
+        stats.ops++;
+
+        {
+            StageTimer timer(stage_stats.get(), Stage::UNPACK);
+            vec::unpack<T, uint8_t>(
+                output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+        }
+
+        StageTimer timer(stage_stats.get(), Stage::COPY);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            if (wanted_idxs[i]) {
+                memcpy(
+                    parities_bufs[i] + offset * word_size,
+                    reinterpret_cast<char*>(output_mem_char.at(i)),
+                    copy_size * word_size);
             }
         }
         offset += pkt_size;
     }
 
-    return true;
+    // properties of the outputs left undefined are meaningless
+    if (pruned) {
+        for (unsigned i = 0; i < n_outputs; i++) {
+            if (!wanted_idxs[i]) {
+                props[i].clear();
+            }
+        }
+    }
 }
 
 /** Encode blocks
@@ -1057,10 +1606,15 @@ bool FecCode<T>::decode_streams_vertical(
  * (set entries to nullptr when not wanted)
  * @param wanted_idxs bool array of missing_idxs of len n_outputs indicating
  * wanted (value 1) or not wanted fragments (value 0) - wanted blocks MUST BE
- * allocated by caller
+ * allocated by caller. When only a few outputs are wanted, codecs may skip the
+ * others: their properties are then left empty.
  * @param block_size_bytes the block size in bytes
  *
  * @pre All blocks must be of equal size
+ *
+ * @note When several threads are set (see `set_n_threads`), the block is
+ * split into ranges of packets encoded concurrently. Properties of each range
+ * are merged in order, hence they are the same as for a single thread.
  */
 template <typename T>
 void FecCode<T>::encode_blocks_vertical(
@@ -1079,75 +1633,437 @@ void FecCode<T>::encode_blocks_vertical(
         props.clear();
     }
 
-    size_t offset = 0;
-    size_t block_size = block_size_bytes / word_size;
+    const size_t block_size = block_size_bytes / word_size;
 
-    // vector of buffers storing data read from chunk
-    vec::Buffers<uint8_t> words_char(n_data, buf_size);
-    const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
-    // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> words(n_data, pkt_size);
-    const std::vector<T*> words_mem_T = words.get_mem();
+    reset_stats_enc();
 
-    int output_len = get_n_outputs();
+    const size_t n_pkts = (block_size + pkt_size - 1) / pkt_size;
+    const size_t n_ranges = get_n_ranges(n_pkts);
+    reserve_block_scratch(n_ranges);
+    std::vector<RangeStats>& stats = ranges_stats;
+
+    if (n_ranges <= 1) {
+        encode_range(
+            nullptr,
+            *block_bufs[0],
+            data_bufs,
+            parities_bufs,
+            parities_props,
+            wanted_idxs,
+            0,
+            block_size,
+            stats[0]);
+    } else {
+        for (size_t r = 0; r < n_ranges; ++r) {
+            for (auto& props : ranges_props[r]) {
+                props.clear();
+            }
+        }
 
-    // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
-    const std::vector<T*> output_mem_T = output.get_mem();
-    // vector of buffers storing data in output chunk
-    vec::Buffers<uint8_t> output_char(output_len, buf_size);
-    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
+        pool->run(n_ranges, [&](size_t r) {
+            const size_t begin = get_range_begin(r, n_ranges, n_pkts);
+            const size_t end =
+                std::min(get_range_begin(r + 1, n_ranges, n_pkts), block_size);
+            encode_range(
+                block_workspaces[r].get(),
+                *block_bufs[r],
+                data_bufs,
+                parities_bufs,
+                ranges_props[r],
+                wanted_idxs,
+                begin,
+                end,
+                stats[r]);
+        });
+
+        StageTimer timer(stage_stats.get(), Stage::PROPS);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            for (size_t r = 0; r < n_ranges; ++r) {
+                parities_props[i].append(ranges_props[r][i]);
+            }
+        }
+    }
 
-    reset_stats_enc();
+    for (const auto& range_stats : stats) {
+        total_enc_usec += range_stats.usec;
+        total_encode_cycles += range_stats.cycles;
+        n_encode_ops += range_stats.ops;
+    }
+}
 
-    while (offset < block_size) {
-        size_t remain_size = block_size - offset;
-        size_t copy_size = std::min(pkt_size, remain_size);
-        for (unsigned i = 0; i < n_data; i++) {
-            memcpy(
-                reinterpret_cast<char*>(words_mem_char.at(i)),
-                data_bufs[i] + offset * word_size,
-                copy_size * word_size);
+/** Encode several stripes of blocks at once
+ *
+ * It gives the same result as encoding each stripe with
+ * `encode_blocks_vertical`, but the setup of the encoding is shared by all
+ * stripes. This matters for small blocks, whose encoding costs about as much
+ * as this setup.
+ *
+ * @param data_bufs data blocks of each stripe, see `encode_blocks_vertical`
+ * @param parities_bufs parity blocks of each stripe
+ * @param parities_props properties of the parities of each stripe
+ * @param wanted_idxs wanted parities, the same for all stripes
+ * @param block_size_bytes the block size in bytes
+ *
+ * @pre All blocks of all stripes must be of equal size
+ *
+ * @note When several threads are set (see `set_n_threads`), stripes are
+ * spread over the threads, and each stripe is encoded by a single thread.
+ */
+template <typename T>
+void FecCode<T>::encode_stripes_vertical(
+    const std::vector<std::vector<uint8_t*>>& data_bufs,
+    const std::vector<std::vector<uint8_t*>>& parities_bufs,
+    std::vector<std::vector<Properties>>& parities_props,
+    const std::vector<bool>& wanted_idxs,
+    size_t block_size_bytes)
+{
+    const size_t n_stripes = data_bufs.size();
+    assert(parities_bufs.size() == n_stripes);
+    assert(parities_props.size() == n_stripes);
+
+    for (size_t s = 0; s < n_stripes; ++s) {
+        assert(data_bufs[s].size() == n_data);
+        assert(parities_bufs[s].size() == n_outputs);
+        assert(parities_props[s].size() == n_outputs);
+
+        for (auto& props : parities_props[s]) {
+            props.clear();
         }
+    }
 
-        // Zero-out trailing part of data
-        if (copy_size < pkt_size) {
-            const size_t copy_bytes = copy_size * word_size;
-            const size_t trailing_bytes = buf_size - copy_bytes;
-            for (unsigned i = 0; i < n_data; i++) {
-                memset(
-                    reinterpret_cast<char*>(words_mem_char.at(i)) + copy_bytes,
+    const size_t block_size = block_size_bytes / word_size;
+
+    reset_stats_enc();
+
+    const size_t n_tasks = get_n_ranges(n_stripes);
+    reserve_block_scratch(n_tasks);
+    std::vector<RangeStats>& stats = ranges_stats;
+
+    if (n_tasks <= 1) {
+        for (size_t s = 0; s < n_stripes; ++s) {
+            encode_range(
+                nullptr,
+                *block_bufs[0],
+                data_bufs[s],
+                parities_bufs[s],
+                parities_props[s],
+                wanted_idxs,
+                0,
+                block_size,
+                stats[0]);
+        }
+    } else {
+        pool->run(n_tasks, [&](size_t t) {
+            const size_t end = (t + 1) * n_stripes / n_tasks;
+            for (size_t s = t * n_stripes / n_tasks; s < end; ++s) {
+                encode_range(
+                    block_workspaces[t].get(),
+                    *block_bufs[t],
+                    data_bufs[s],
+                    parities_bufs[s],
+                    parities_props[s],
+                    wanted_idxs,
                     0,
-                    trailing_bytes);
+                    block_size,
+                    stats[t]);
             }
+        });
+    }
+
+    for (const auto& range_stats : stats) {
+        total_enc_usec += range_stats.usec;
+        total_encode_cycles += range_stats.cycles;
+        n_encode_ops += range_stats.ops;
+    }
+}
+
+/** Update parity blocks after a data block was overwritten
+ *
+ * As the code is linear, each output is updated by adding to it the encoding
+ * of the difference between the new and the old data block. Only the
+ * overwritten data block and the parities are read.
+ *
+ * @param fragment_index index of the overwritten data block
+ * @param old_data previous content of the data block
+ * @param new_data new content of the data block
+ * @param parities_bufs vector size must be exactly n_outputs, blocks encoded by
+ * `encode_blocks_vertical` (set entries to nullptr when not to update)
+ * @param parities_props vector size must be exactly n_outputs, properties of
+ * the parities. Those of the updated parities are replaced
+ * @param block_size_bytes the block size in bytes
+ *
+ * @pre All blocks must be of equal size, and properties sorted (as given by
+ * the encoding)
+ */
+template <typename T>
+void FecCode<T>::update_parities(
+    unsigned fragment_index,
+    const uint8_t* old_data,
+    const uint8_t* new_data,
+    const std::vector<uint8_t*>& parities_bufs,
+    std::vector<Properties>& parities_props,
+    size_t block_size_bytes)
+{
+    assert(parities_bufs.size() == n_outputs);
+    assert(parities_props.size() == n_outputs);
+
+    if (!is_update_supported()) {
+        throw LogicError("FEC base: parity update is not supported");
+    }
+    if (fragment_index >= n_data) {
+        throw InvalidArgument("FEC base: invalid data fragment index");
+    }
+
+    const size_t block_size = block_size_bytes / word_size;
+    const T thres = gf->card() - 1;
+
+    // Coefficient of the data fragment in each output, given by the encoding
+    // of a unit packet
+    std::vector<T> coefs(n_outputs);
+    {
+        vec::Buffers<T> unit(n_data, pkt_size);
+        unit.zero_fill();
+        std::fill_n(unit.get(fragment_index), pkt_size, 1);
+        vec::Buffers<T> unit_output(get_n_outputs(), pkt_size);
+        std::vector<Properties> unit_props(get_n_outputs());
+        encode(unit_output, unit_props, 0, unit);
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            coefs[i] = unit_output.get(i)[0];
         }
+    }
 
+    // Row 0 holds the old data then the difference, row 1 the new data and
+    // row 2 the contribution of the difference to an output
+    vec::Buffers<uint8_t> words_char(2, buf_size);
+    const std::vector<uint8_t*>& words_mem_char = words_char.get_mem();
+    vec::Buffers<T> words(3, pkt_size);
+    const std::vector<T*>& words_mem_T = words.get_mem();
+    T* delta = words.get(0);
+    T* contrib = words.get(2);
+
+    // parity being updated
+    vec::Buffers<uint8_t> parity_char(1, buf_size);
+    const std::vector<uint8_t*>& parity_mem_char = parity_char.get_mem();
+    vec::Buffers<T> parity_words(1, pkt_size);
+    const std::vector<T*>& parity_mem_T = parity_words.get_mem();
+    T* parity = parity_words.get(0);
+
+    std::vector<size_t> props_indices(n_outputs, 0);
+    std::vector<Properties> new_props(n_outputs);
+
+    for (size_t offset = 0; offset < block_size; offset += pkt_size) {
+        const size_t copy_size = std::min(pkt_size, block_size - offset);
+        const size_t copy_bytes = copy_size * word_size;
+
+        words_char.zero_fill();
+        memcpy(words_mem_char[0], old_data + offset * word_size, copy_bytes);
+        memcpy(words_mem_char[1], new_data + offset * word_size, copy_bytes);
         vec::pack<uint8_t, T>(
-            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+            words_mem_char, words_mem_T, 2, pkt_size, word_size);
+        gf->sub_two_bufs(words.get(1), delta, delta, pkt_size);
 
-        timeval t1 = tick();
-        uint64_t start = hw_timer();
-        encode(output, parities_props, offset, words);
-        uint64_t end = hw_timer();
-        uint64_t t2 = hrtime_usec(t1);
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            if (parities_bufs[i] == nullptr) {
+                continue;
+            }
+            uint8_t* block = parities_bufs[i] + offset * word_size;
+            parity_char.zero_fill();
+            memcpy(parity_mem_char[0], block, copy_bytes);
+            vec::pack<uint8_t, T>(
+                parity_mem_char, parity_mem_T, 1, pkt_size, word_size);
+
+            // Restore the values that do not fit in a word.
+            const Properties& props = parities_props[i];
+            size_t& index = props_indices[i];
+            while (props.in_range(index, offset, offset + copy_size)) {
+                if (props.marker(index) == OOR_MARK) {
+                    parity[props.location(index) - offset] = thres;
+                }
+                ++index;
+            }
 
-        total_enc_usec += t2;
-        total_encode_cycles += (end - start) / (copy_size * word_size);
-        n_encode_ops++;
+            // Coefficients 1 and `card - 1` are not handled by the
+            // multiplication kernels (see `mul_vec_to_vecp`).
+            const T coef = coefs[i];
+            if (coef == 1) {
+                gf->add_two_bufs(delta, parity, pkt_size);
+            } else if (coef == thres) {
+                gf->sub_two_bufs(parity, delta, parity, pkt_size);
+            } else if (coef != 0) {
+                gf->mul_coef_to_buf(coef, delta, contrib, pkt_size);
+                gf->add_two_bufs(contrib, parity, pkt_size);
+            }
 
-        vec::unpack<T, uint8_t>(
-            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+            for (size_t j = 0; j < copy_size; ++j) {
+                if (parity[j] == thres) {
+                    new_props[i].add(offset + j, OOR_MARK);
+                }
+            }
 
-        for (unsigned i = 0; i < n_outputs; i++) {
-            if (wanted_idxs[i]) {
-                memcpy(
-                    parities_bufs[i] + offset * word_size,
-                    reinterpret_cast<char*>(output_mem_char.at(i)),
-                    copy_size * word_size);
+            vec::unpack<T, uint8_t>(
+                parity_mem_T, parity_mem_char, 1, pkt_size, word_size);
+            memcpy(block, parity_mem_char[0], copy_bytes);
+        }
+    }
+
+    for (unsigned i = 0; i < n_outputs; ++i) {
+        if (parities_bufs[i] != nullptr) {
+            parities_props[i] = std::move(new_props[i]);
+        }
+    }
+}
+
+/** Rebuild a single lost fragment
+ *
+ * Contrary to `decode_blocks_vertical`, only the lost fragment is computed:
+ * it is the Lagrange interpolation, at its evaluation point, of `n_data`
+ * available fragments. Each rebuilt word costs `n_data` multiply-adds.
+ *
+ * @param fragment_index index of the fragment to rebuild, from 0 to
+ * code_len - 1 (see `missing_idxs`)
+ * @param data_bufs vector size must be exactly n_data, only used for
+ * SYSTEMATIC (set entries to nullptr when missing)
+ * @param parities_bufs vector size must be exactly n_outputs
+ * (set entries to nullptr when missing)
+ * @param parities_props vector size must be exactly n_outputs, properties of
+ * the available parities
+ * @param missing_idxs array of missing indexes of vector size code_len
+ * indicating presence (value 0) or absence (value 1) of fragments
+ * @param output rebuilt fragment, allocated by caller
+ * @param output_props properties of the rebuilt fragment
+ * @param block_size_bytes the block size in bytes
+ *
+ * @pre All blocks must be of equal size, and properties sorted (as given by
+ * the encoding)
+ *
+ * @return true if the fragment was rebuilt, false if less than n_data
+ * fragments are available
+ */
+template <typename T>
+bool FecCode<T>::repair_block_vertical(
+    unsigned fragment_index,
+    const std::vector<uint8_t*>& data_bufs,
+    const std::vector<uint8_t*>& parities_bufs,
+    const std::vector<Properties>& parities_props,
+    const std::vector<int>& missing_idxs,
+    uint8_t* output,
+    Properties& output_props,
+    size_t block_size_bytes)
+{
+    if (type == FecType::SYSTEMATIC) {
+        assert(data_bufs.size() == n_data);
+    }
+    assert(parities_bufs.size() == n_outputs);
+    assert(parities_props.size() == n_outputs);
+
+    if (!is_repair_supported()) {
+        throw LogicError("FEC base: fragment repair is not supported");
+    }
+    if (fragment_index >= code_len) {
+        throw InvalidArgument("FEC base: invalid fragment index");
+    }
+
+    const size_t block_size = block_size_bytes / word_size;
+    const T thres = gf->card() - 1;
+
+    // Fragments used for the interpolation: their indices, blocks and
+    // properties (none for the data of a SYSTEMATIC code).
+    std::vector<unsigned> ids;
+    std::vector<const uint8_t*> bufs;
+    std::vector<const Properties*> props;
+    ids.reserve(n_data);
+    bufs.reserve(n_data);
+    props.reserve(n_data);
+    if (type == FecType::SYSTEMATIC) {
+        for (unsigned i = 0; i < n_data && ids.size() < n_data; i++) {
+            if (!missing_idxs[i]) {
+                ids.push_back(i);
+                bufs.push_back(data_bufs[i]);
+                props.push_back(nullptr);
             }
         }
-        offset += pkt_size;
     }
+    for (unsigned i = 0; i < n_outputs && ids.size() < n_data; i++) {
+        const unsigned j = (type == FecType::SYSTEMATIC) ? n_data + i : i;
+        if (!missing_idxs[j]) {
+            ids.push_back(j);
+            bufs.push_back(parities_bufs[i]);
+            props.push_back(&parities_props[i]);
+        }
+    }
+    if (ids.size() < n_data) {
+        return false;
+    }
+
+    // Lagrange basis at the point of the fragment:
+    // w_i = prod_{l != i} (x - x_l) / (x_i - x_l)
+    const T x = r_powers->get(fragment_index);
+    vec::Vector<T> weights(*gf, n_data);
+    for (unsigned i = 0; i < n_data; i++) {
+        const T x_i = r_powers->get(ids[i]);
+        T num = 1;
+        T den = 1;
+        for (unsigned l = 0; l < n_data; l++) {
+            if (l != i) {
+                const T x_l = r_powers->get(ids[l]);
+                num = gf->mul(num, gf->sub(x, x_l));
+                den = gf->mul(den, gf->sub(x_i, x_l));
+            }
+        }
+        weights.set(i, gf->div(num, den));
+    }
+
+    vec::Buffers<uint8_t> words_char(n_data, buf_size);
+    const std::vector<uint8_t*>& words_mem_char = words_char.get_mem();
+    vec::Buffers<T> words(n_data, pkt_size);
+    const std::vector<T*>& words_mem_T = words.get_mem();
+    T* result = words.get(0);
+
+    std::vector<size_t> props_indices(n_data, 0);
+    output_props.clear();
+
+    for (size_t offset = 0; offset < block_size; offset += pkt_size) {
+        const size_t copy_size = std::min(pkt_size, block_size - offset);
+        const size_t copy_bytes = copy_size * word_size;
+
+        for (unsigned i = 0; i < n_data; i++) {
+            memcpy(words_mem_char[i], bufs[i] + offset * word_size, copy_bytes);
+            memset(words_mem_char[i] + copy_bytes, 0, buf_size - copy_bytes);
+        }
+        vec::pack<uint8_t, T>(
+            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+
+        // Restore the values that do not fit in a word.
+        for (unsigned i = 0; i < n_data; i++) {
+            if (props[i] == nullptr) {
+                continue;
+            }
+            size_t& index = props_indices[i];
+            while (props[i]->in_range(index, offset, offset + copy_size)) {
+                if (props[i]->marker(index) == OOR_MARK) {
+                    words.get(i)[props[i]->location(index) - offset] = thres;
+                }
+                ++index;
+            }
+        }
+
+        gf->mul_vec_to_vecp(weights, words, words);
+        for (unsigned i = 1; i < n_data; i++) {
+            gf->add_two_bufs(words.get(i), result, pkt_size);
+        }
+
+        for (size_t j = 0; j < copy_size; ++j) {
+            if (result[j] == thres) {
+                output_props.add(offset + j, OOR_MARK);
+            }
+        }
+
+        vec::unpack<T, uint8_t>(
+            words_mem_T, words_mem_char, 1, pkt_size, word_size);
+        memcpy(output + offset * word_size, words_mem_char[0], copy_bytes);
+    }
+
+    return true;
 }
 
 /** Decode blocks
@@ -1171,6 +2087,9 @@ void FecCode<T>::encode_blocks_vertical(
  *
  * @pre All blocks must be of equal size
  *
+ * @note When several threads are set (see `set_n_threads`), the block is
+ * split into ranges of packets decoded concurrently.
+ *
  * @return true if decode succeeded, else false
  */
 template <typename T>
@@ -1182,7 +2101,6 @@ bool FecCode<T>::decode_blocks_vertical(
     std::vector<bool>& wanted_idxs,
     size_t block_size_bytes)
 {
-    size_t offset = 0;
     size_t block_size = block_size_bytes / word_size;
 
     unsigned fragment_index = 0;
@@ -1237,84 +2155,182 @@ bool FecCode<T>::decode_blocks_vertical(
 
     decode_build();
 
-    // vector of buffers storing data read from chunk
-    vec::Buffers<uint8_t> words_char(n_data, buf_size);
-    const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
-    // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> words(n_data, pkt_size);
-    const std::vector<T*> words_mem_T = words.get_mem();
-
-    int output_len = n_data;
-
-    // vector of buffers storing data that are performed in decoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
-    const std::vector<T*> output_mem_T = output.get_mem();
-    // vector of buffers storing data in output chunk
-    vec::Buffers<uint8_t> output_char(output_len, buf_size);
-    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
+    const int output_len = n_data;
+
+    // Decode packets from `begin` to `end` (offsets in words)
+    auto decode_range = [&](Workspace<T>* workspace,
+                            BlockBuffers<T>& bufs,
+                            DecodeContext<T>& context,
+                            vec::Buffers<T>& output,
+                            size_t begin,
+                            size_t end,
+                            RangeStats& stats) {
+        // vector of buffers storing data read from chunk
+        const std::vector<uint8_t*>& words_mem_char = bufs.words_char.get_mem();
+        // vector of buffers storing data that are performed in encoding, i.e.
+        // FFT
+        vec::Buffers<T>& words = bufs.words;
+        const std::vector<T*>& words_mem_T = words.get_mem();
+
+        const std::vector<T*>& output_mem_T = output.get_mem();
+        // vector of buffers storing data in output chunk
+        const std::vector<uint8_t*>& output_mem_char =
+            bufs.output_char.get_mem();
+
+        size_t offset = begin;
+        while (offset < end) {
+            size_t remain_size = end - offset;
+            size_t copy_size = std::min(pkt_size, remain_size);
+            {
+                StageTimer timer(stage_stats.get(), Stage::COPY);
+                if (type == FecType::SYSTEMATIC) {
+                    for (unsigned i = 0; i < avail_data_nb; i++) {
+                        unsigned data_idx = fragments_ids.get(i);
+                        memcpy(
+                            reinterpret_cast<char*>(words_mem_char.at(i)),
+                            data_bufs[data_idx] + offset * word_size,
+                            copy_size * word_size);
+                    }
+                }
+                for (unsigned i = 0; i < n_data - avail_data_nb; ++i) {
+                    unsigned parity_idx = avail_parity_ids.get(i);
+                    memcpy(
+                        reinterpret_cast<char*>(
+                            words_mem_char.at(avail_data_nb + i)),
+                        parities_bufs[parity_idx] + offset * word_size,
+                        copy_size * word_size);
+                }
 
-    std::unique_ptr<DecodeContext<T>> context =
-        init_context_dec(fragments_ids, parities_props, pkt_size, &output);
+                // Zero-out trailing part of data
+                if (copy_size < pkt_size) {
+                    const size_t copy_bytes = copy_size * word_size;
+                    const size_t trailing_bytes = buf_size - copy_bytes;
+                    for (unsigned i = 0; i < n_data; i++) {
+                        memset(
+                            reinterpret_cast<char*>(words_mem_char.at(i))
+                                + copy_bytes,
+                            0,
+                            trailing_bytes);
+                    }
+                }
+            }
 
-    reset_stats_dec();
+            {
+                StageTimer timer(stage_stats.get(), Stage::PACK);
+                vec::pack<uint8_t, T>(
+                    words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+            }
 
-    while (offset < block_size) {
-        size_t remain_size = block_size - offset;
-        size_t copy_size = std::min(pkt_size, remain_size);
-        if (type == FecType::SYSTEMATIC) {
-            for (unsigned i = 0; i < avail_data_nb; i++) {
-                unsigned data_idx = fragments_ids.get(i);
-                memcpy(
-                    reinterpret_cast<char*>(words_mem_char.at(i)),
-                    data_bufs[data_idx] + offset * word_size,
-                    copy_size * word_size);
+            timeval t1 = tick();
+            uint64_t start = hw_timer();
+            if (workspace) {
+                decode_with_workspace(
+                    *workspace, context, output, parities_props, offset, words);
+            } else {
+                decode(context, output, parities_props, offset, words);
+            }
+            uint64_t end_time = hw_timer();
+            uint64_t t2 = hrtime_usec(t1);
+
+            stats.usec += t2;
+            stats.cycles += (end_time - start) / word_size;
+            stats.ops++;
+
+            {
+                StageTimer timer(stage_stats.get(), Stage::UNPACK);
+                vec::unpack<T, uint8_t>(
+                    output_mem_T,
+                    output_mem_char,
+                    output_len,
+                    pkt_size,
+                    word_size);
             }
-        }
-        for (unsigned i = 0; i < n_data - avail_data_nb; ++i) {
-            unsigned parity_idx = avail_parity_ids.get(i);
-            memcpy(
-                reinterpret_cast<char*>(words_mem_char.at(avail_data_nb + i)),
-                parities_bufs[parity_idx] + offset * word_size,
-                copy_size * word_size);
-        }
 
-        // Zero-out trailing part of data
-        if (copy_size < pkt_size) {
-            const size_t copy_bytes = copy_size * word_size;
-            const size_t trailing_bytes = buf_size - copy_bytes;
+            StageTimer timer(stage_stats.get(), Stage::COPY);
             for (unsigned i = 0; i < n_data; i++) {
-                memset(
-                    reinterpret_cast<char*>(words_mem_char.at(i)) + copy_bytes,
-                    0,
-                    trailing_bytes);
+                if (wanted_idxs[i]) {
+                    memcpy(
+                        data_bufs[i] + offset * word_size,
+                        reinterpret_cast<char*>(output_mem_char.at(i)),
+                        copy_size * word_size);
+                }
             }
+            offset += pkt_size;
         }
+    };
 
-        vec::pack<uint8_t, T>(
-            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
-
-        timeval t1 = tick();
-        uint64_t start = hw_timer();
-        decode(*context, output, parities_props, offset, words);
-        uint64_t end = hw_timer();
-        uint64_t t2 = hrtime_usec(t1);
-
-        total_dec_usec += t2;
-        total_decode_cycles += (end - start) / word_size;
-        n_decode_ops++;
+    reset_stats_dec();
 
-        vec::unpack<T, uint8_t>(
-            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+    const size_t n_pkts = (block_size + pkt_size - 1) / pkt_size;
+    const size_t n_ranges = get_n_ranges(n_pkts);
+    reserve_block_scratch(n_ranges);
+    std::vector<RangeStats>& stats = ranges_stats;
+
+    // Decoding states, one per range, reused from a previous decoding with the
+    // same fragments if possible. They are all prepared upfront as preparing
+    // them sorts the properties.
+    std::vector<DecodeState<T>> states =
+        dec_contexts.take(fragments_ids, pkt_size);
+    for (size_t r = 0; r < n_ranges; ++r) {
+        if (r == states.size()) {
+            // vector of buffers storing data that are performed in decoding,
+            // i.e. FFT
+            DecodeState<T> state;
+            state.output =
+                std::make_unique<vec::Buffers<T>>(output_len, pkt_size);
+            StageTimer timer(stage_stats.get(), Stage::CONTEXT_BUILD);
+            state.context = init_context_dec(
+                fragments_ids, parities_props, pkt_size, state.output.get());
+            states.push_back(std::move(state));
+        } else if (states[r].context) {
+            StageTimer timer(stage_stats.get(), Stage::PROPS);
+            states[r].context->reset(parities_props);
+        }
+    }
 
-        for (unsigned i = 0; i < n_data; i++) {
-            if (wanted_idxs[i]) {
-                memcpy(
-                    data_bufs[i] + offset * word_size,
-                    reinterpret_cast<char*>(output_mem_char.at(i)),
-                    copy_size * word_size);
+    if (n_ranges <= 1) {
+        decode_range(
+            nullptr,
+            *block_bufs[0],
+            *states[0].context,
+            *states[0].output,
+            0,
+            block_size,
+            stats[0]);
+    } else {
+        {
+            StageTimer timer(stage_stats.get(), Stage::PROPS);
+            for (size_t r = 0; r < n_ranges; ++r) {
+                // Skip the properties located before the range.
+                const size_t begin = get_range_begin(r, n_ranges, n_pkts);
+                for (unsigned i = 0; i < n_outputs; i++) {
+                    states[r].context->props_indices.at(i) =
+                        parities_props[i].lower_bound(begin);
+                }
             }
         }
-        offset += pkt_size;
+
+        pool->run(n_ranges, [&](size_t r) {
+            const size_t begin = get_range_begin(r, n_ranges, n_pkts);
+            const size_t end =
+                std::min(get_range_begin(r + 1, n_ranges, n_pkts), block_size);
+            decode_range(
+                block_workspaces[r].get(),
+                *block_bufs[r],
+                *states[r].context,
+                *states[r].output,
+                begin,
+                end,
+                stats[r]);
+        });
+    }
+
+    dec_contexts.put(fragments_ids, pkt_size, std::move(states));
+
+    for (const auto& range_stats : stats) {
+        total_dec_usec += range_stats.usec;
+        total_decode_cycles += range_stats.cycles;
+        n_decode_ops += range_stats.ops;
     }
 
     return true;
@@ -1339,17 +2355,55 @@ void FecCode<T>::decode(
     const std::vector<Properties>& props,
     off_t offset,
     vec::Buffers<T>& words)
+{
+    decode_with_inter_codeword(
+        dec_inter_codeword.get(), context, output, props, offset, words);
+}
+
+template <typename T>
+void FecCode<T>::decode_with_workspace(
+    Workspace<T>& workspace,
+    DecodeContext<T>& context,
+    vec::Buffers<T>& output,
+    const std::vector<Properties>& props,
+    off_t offset,
+    vec::Buffers<T>& words)
+{
+    decode_with_inter_codeword(
+        workspace.dec_inter_codeword.get(),
+        context,
+        output,
+        props,
+        offset,
+        words);
+}
+
+template <typename T>
+void FecCode<T>::decode_with_inter_codeword(
+    vec::Buffers<T>* inter_codeword,
+    DecodeContext<T>& context,
+    vec::Buffers<T>& output,
+    const std::vector<Properties>& props,
+    off_t offset,
+    vec::Buffers<T>& words)
 {
     // prepare for decoding
-    decode_prepare(context, props, offset, words);
+    {
+        StageTimer timer(stage_stats.get(), Stage::PROPS);
+        decode_prepare(context, props, offset, words);
+    }
 
     // Lagrange interpolation
     decode_apply(context, output, words);
 
     if (type == FecType::SYSTEMATIC) {
-        this->fft->fft(*dec_inter_codeword, output);
+        {
+            StageTimer timer(stage_stats.get(), Stage::FFT);
+            this->fft->fft(*inter_codeword, output);
+        }
+        StageTimer timer(stage_stats.get(), Stage::COPY);
         for (unsigned i = 0; i < this->n_data; i++) {
-            output.copy(i, dec_inter_codeword->get(i));
+            output.copy(i, inter_codeword->get(i));
         }
     }
 }
@@ -1407,18 +2461,26 @@ void FecCode<T>::decode_prepare(
  * Perform a Lagrange interpolation to find the coefficients of the
  * polynomial
  *
- * @note If all fragments are available ifft(words) is enough
+ * It is shared by the codes whose decoding runs on another field than the
+ * one of the code, e.g. the lanes of fec::RsNf4.
  *
+ * @param gf field of the context
+ * @param fft FFT of length `n` of the context
+ * @param fft_2k FFT of length `len_2k` of the context
  * @param context decoding context
- * @param output must be exactly n_data
- * @param words vector \f$v=(v_0, v_1, ..., v_{k-1})\f$, \f$k\f$ must be exactly
- * n_data
+ * @param output buffers the context was created with
+ * @param words \f$k\f$ buffers of received symbols
+ * @param stats stage statistics to fill, or nullptr
  */
 template <typename T>
-void FecCode<T>::decode_apply(
+void lagrange_interpolate(
+    const gf::Field<T>& gf,
+    fft::FourierTransform<T>& fft,
+    fft::FourierTransform<T>& fft_2k,
     DecodeContext<T>& context,
     vec::Buffers<T>& output,
-    vec::Buffers<T>& words)
+    vec::Buffers<T>& words,
+    StageStats* stats)
 {
     vec::Vector<T>& inv_A_i = context.get_vector(CtxVec::INV_A_I);
     vec::Vector<T>& A_fft_2k = context.get_vector(CtxVec::A_FFT_2K);
@@ -1431,20 +2493,60 @@ void FecCode<T>::decode_apply(
 
     // compute N'(x) = sum_i{n_i * x^z_i}
     // where n_i=v_i/A'_i(x_i)
-    this->gf->mul_vec_to_vecp(inv_A_i, words, buf1_k);
+    {
+        StageTimer timer(stats, Stage::HADAMARD);
+        gf.mul_vec_to_vecp(inv_A_i, words, buf1_k);
+    }
 
-    // compute buf2_n
-    this->fft->fft_inv(buf2_n, buf1_n);
+    {
+        StageTimer timer(stats, Stage::FFT);
+        // compute buf2_n
+        fft.fft_inv(buf2_n, buf1_n);
 
-    this->fft_2k->fft(buf1_2k, output);
+        fft_2k.fft(buf1_2k, output);
+    }
 
     // multiply FFT(A) and buf2_2k
-    this->gf->mul_vec_to_vecp(A_fft_2k, buf1_2k, buf1_2k);
+    {
+        StageTimer timer(stats, Stage::HADAMARD);
+        gf.mul_vec_to_vecp(A_fft_2k, buf1_2k, buf1_2k);
+    }
 
-    this->fft_2k->ifft(buf2_2k, buf1_2k);
+    {
+        StageTimer timer(stats, Stage::FFT);
+        fft_2k.ifft(buf2_2k, buf1_2k);
+    }
 
     // negatize output
-    this->gf->neg(output);
+    StageTimer timer(stats, Stage::HADAMARD);
+    gf.neg(output);
+}
+
+/**
+ * Perform a Lagrange interpolation to find the coefficients of the
+ * polynomial
+ *
+ * @note If all fragments are available ifft(words) is enough
+ *
+ * @param context decoding context
+ * @param output must be exactly n_data
+ * @param words vector \f$v=(v_0, v_1, ..., v_{k-1})\f$, \f$k\f$ must be exactly
+ * n_data
+ */
+template <typename T>
+void FecCode<T>::decode_apply(
+    DecodeContext<T>& context,
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& words)
+{
+    lagrange_interpolate(
+        *(this->gf),
+        *(this->fft),
+        *(this->fft_2k),
+        context,
+        output,
+        words,
+        stage_stats.get());
 }
 
 } // namespace fec
@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <vector>
 #include <sys/time.h>
@@ -75,8 +76,11 @@ class DecodeContext {
         int vx_zero = -1,
         const size_t size = 0,
         vec::Buffers<T>* output = nullptr)
-        : props_indices(input_props.size(), 0)
+        : fragments_ids(gf, fragments_ids.get_n())
     {
+        for (int i = 0; i < fragments_ids.get_n(); ++i) {
+            this->fragments_ids.set(i, fragments_ids.get(i));
+        }
         this->k = k;
         this->n = n;
         this->size = size;
@@ -88,13 +92,7 @@ class DecodeContext {
         this->len_2k = this->gf->get_code_len_high_compo(2 * this->k);
         this->max_n_2k = (this->n > this->len_2k) ? this->n : this->len_2k;
 
-        this->fragments_ids = &fragments_ids;
-
-        for (auto& props : input_props) {
-            // Sort properties on the basis of location of pairs in ascending
-            // order.
-            props.sort();
-        }
+        reset(input_props);
 
         A = std::make_unique<vec::Poly<T>>(gf, n);
         A_fft_2k = std::make_unique<vec::Vector<T>>(gf, len_2k);
@@ -141,7 +139,21 @@ class DecodeContext {
         init(vx);
     }
 
-    ~DecodeContext() = default;
+    virtual ~DecodeContext() = default;
+
+    /** Prepare the context for decoding with a new set of properties
+     *
+     * @param input_props properties bound to the fragments to decode
+     */
+    void reset(std::vector<Properties>& input_props)
+    {
+        for (auto& props : input_props) {
+            // Sort properties on the basis of location of pairs in ascending
+            // order.
+            props.sort();
+        }
+        props_indices.assign(input_props.size(), 0);
+    }
 
     unsigned get_len_2k() const
     {
@@ -150,7 +162,7 @@ class DecodeContext {
 
     const vec::Vector<T>& get_fragments_id() const
     {
-        return *fragments_ids;
+        return fragments_ids;
     }
 
     vec::Vector<T>& get_vector(CtxVec type) const
@@ -210,7 +222,7 @@ class DecodeContext {
         vx_zero = -1;
         // vector x=(x_0, x_1, ..., x_k-1)
         for (int i = 0; i < k; ++i) {
-            if (betas->get(fragments_ids->get(i)) == 0) {
+            if (betas->get(fragments_ids.get(i)) == 0) {
                 vx_zero = i;
                 break;
             }
@@ -257,7 +269,7 @@ class DecodeContext {
         // compute 1/(x_i * A_i(x_i))
         // we care only about elements corresponding to fragments_ids
         for (int i = 0; i < static_cast<int>(k); ++i) {
-            unsigned j = fragments_ids->get(i);
+            unsigned j = fragments_ids.get(i);
             if (i != vx_zero) {
                 inv_A_i->set(
                     i, this->gf->inv(this->gf->mul(_A_fft.get(j), vx.get(i))));
@@ -273,6 +285,9 @@ class DecodeContext {
         }
     }
 
+    // A copy, so that the context can outlive the ids it was built for.
+    vec::Vector<T> fragments_ids;
+
   public:
     int vx_zero;
     std::vector<size_t> props_indices;
@@ -287,8 +302,6 @@ class DecodeContext {
     fft::FourierTransform<T>* fft;
     fft::FourierTransform<T>* fft_2k;
 
-    const vec::Vector<T>* fragments_ids;
-
     std::unique_ptr<vec::Poly<T>> A = nullptr;
     std::unique_ptr<vec::Vector<T>> A_fft_2k = nullptr;
     std::unique_ptr<vec::Vector<T>> inv_A_i = nullptr;
@@ -318,6 +331,159 @@ class DecodeContext {
     std::unique_ptr<vec::Buffers<T>> buf2_2k = nullptr;
 };
 
+/** Scratch memory used by one user of a codec
+ *
+ * The Buffers-based encoding and decoding write intermediate results into
+ * scratch buffers. A codec owns the ones used by its serial paths, the
+ * parallel paths allocate one workspace per task so that concurrent tasks
+ * never share mutable memory.
+ */
+template <typename T>
+class Workspace {
+  public:
+    virtual ~Workspace() = default;
+
+    // buffers for intermediate symbols used for systematic FNT decoding
+    std::unique_ptr<vec::Buffers<T>> dec_inter_codeword = nullptr;
+};
+
+/** Staging buffers of the block encoding and decoding of a range of packets
+ *
+ * Packets are copied from the blocks into `words_char`, packed into `words`,
+ * and the results are unpacked from `output` (or from the decoding state
+ * output) into `output_char`, before being copied back to the blocks.
+ * `output_len` is the number of outputs of the encoding (see
+ * `FecCode::get_n_outputs`).
+ */
+template <typename T>
+struct BlockBuffers {
+    BlockBuffers(
+        int n_data,
+        int output_len,
+        size_t pkt_size,
+        size_t buf_size)
+        : words_char(n_data, buf_size), words(n_data, pkt_size),
+          output(output_len, pkt_size),
+          output_char(std::max(n_data, output_len), buf_size)
+    {
+    }
+
+    vec::Buffers<uint8_t> words_char;
+    vec::Buffers<T> words;
+    vec::Buffers<T> output;
+    vec::Buffers<uint8_t> output_char;
+};
+
+/** A decoding context along with the output buffers it is bound to */
+template <typename T>
+struct DecodeState {
+    std::unique_ptr<vec::Buffers<T>> output = nullptr;
+    std::unique_ptr<DecodeContext<T>> context = nullptr;
+};
+
+/** A bounded cache of decoding states
+ *
+ * Building a decoding context is costly, yet only a few erasure patterns
+ * happen at a time. The states built for a pattern are kept, keyed by the ids
+ * of the fragments used to decode and the packet size, and the least recently
+ * used pattern is evicted once the cache is full.
+ *
+ * @note Each pattern keeps the buffers of one decoding per range of packets
+ * decoded concurrently.
+ */
+template <typename T>
+class DecodeContextCache {
+  public:
+    /// Number of patterns kept by default
+    static constexpr size_t DEFAULT_CAPACITY = 4;
+
+    explicit DecodeContextCache(size_t capacity = DEFAULT_CAPACITY)
+        : capacity(capacity)
+    {
+    }
+
+    size_t get_capacity() const
+    {
+        return capacity;
+    }
+
+    /** Set the maximum number of patterns kept (0 disables the cache) */
+    void set_capacity(size_t capacity)
+    {
+        this->capacity = capacity;
+        while (entries.size() > capacity) {
+            entries.pop_back();
+        }
+    }
+
+    /// Number of lookups that found the pattern in the cache
+    uint64_t get_hits() const
+    {
+        return hits;
+    }
+
+    /// Number of lookups that didn't find the pattern in the cache
+    uint64_t get_misses() const
+    {
+        return misses;
+    }
+
+    /** Take the states of a pattern out of the cache
+     *
+     * @param fragments_ids ids of the fragments used to decode
+     * @param size packet size
+     * @return the cached states, none on a miss
+     */
+    std::vector<DecodeState<T>>
+    take(const vec::Vector<T>& fragments_ids, size_t size)
+    {
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->size == size && it->fragments_ids == fragments_ids) {
+                std::vector<DecodeState<T>> states = std::move(it->states);
+                entries.erase(it);
+                hits++;
+                return states;
+            }
+        }
+        misses++;
+        return {};
+    }
+
+    /** Put the states of a pattern (back) in the cache, as the most recently
+     * used one.
+     *
+     * @param fragments_ids ids of the fragments used to decode
+     * @param size packet size
+     * @param states the states to keep
+     */
+    void put(
+        const vec::Vector<T>& fragments_ids,
+        size_t size,
+        std::vector<DecodeState<T>> states)
+    {
+        if (capacity == 0) {
+            return;
+        }
+        if (entries.size() == capacity) {
+            entries.pop_back();
+        }
+        entries.push_front({fragments_ids, size, std::move(states)});
+    }
+
+  private:
+    struct Entry {
+        vec::Vector<T> fragments_ids;
+        size_t size;
+        std::vector<DecodeState<T>> states;
+    };
+
+    size_t capacity;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // From the most to the least recently used
+    std::list<Entry> entries;
+};
+
 } // namespace fec
 } // namespace quadiron
 
@@ -60,11 +60,25 @@ class RsFnt : public FecCode<T> {
     // decoding context used in encoding of systematic FNT
     std::unique_ptr<DecodeContext<T>> enc_context;
 
-    // Indices used for accelerated functions
+    /** Scratch memory of one user of the codec, see `Workspace` */
+    struct FntWorkspace : public Workspace<T> {
+        std::unique_ptr<vec::Buffers<T>> inter_words = nullptr;
+        std::unique_ptr<vec::Buffers<T>> suffix_words = nullptr;
+        std::unique_ptr<DecodeContext<T>> enc_context = nullptr;
+    };
+
+    // Kernels and indices used for accelerated functions
+    const simd::FntKernels<T>* simd_kernels;
     size_t simd_vec_len;
     size_t simd_trailing_len;
     size_t simd_offset;
 
+    /** Return the FFT of the codeword, created by `init_fft` */
+    fft::Radix2<T>& get_radix2() const
+    {
+        return static_cast<fft::Radix2<T>&>(*this->fft);
+    }
+
   public:
     RsFnt(
         FecType type,
@@ -76,9 +90,11 @@ class RsFnt : public FecCode<T> {
     {
         this->fec_init();
 
-        // Indices used for accelerated functions
-        const unsigned ratio = simd::countof<T>();
-        simd_vec_len = this->pkt_size / ratio;
+        // Kernels and indices used for accelerated functions
+        simd_kernels = simd::get_fnt_kernels<T>();
+        const unsigned ratio =
+            simd_kernels == nullptr ? 0 : simd_kernels->countof;
+        simd_vec_len = ratio == 0 ? 0 : this->pkt_size / ratio;
         simd_trailing_len = this->pkt_size - simd_vec_len * ratio;
         simd_offset = simd_vec_len * ratio;
     }
@@ -214,22 +230,37 @@ class RsFnt : public FecCode<T> {
         vec::Buffers<T>& buf1_2k = context.get_buffer(CtxBuf::B2K1);
         vec::Buffers<T>& buf2_2k = context.get_buffer(CtxBuf::B2K2);
 
+        StageStats* stats = this->stage_stats.get();
+
         // compute N'(x) = sum_i{n_i * x^z_i}
         // where n_i=v_i/A'_i(x_i)
-        this->gf->mul_vec_to_vecp(inv_A_i, words, buf1_k);
+        {
+            StageTimer timer(stats, Stage::HADAMARD);
+            this->gf->mul_vec_to_vecp(inv_A_i, words, buf1_k);
+        }
 
-        // compute buf2_n
-        // Input `buf1_k` contains first `k` received symbols from 0 .. k-1
-        this->fft->fft_inv(buf2_n, buf1_k);
+        {
+            StageTimer timer(stats, Stage::FFT);
+            // compute buf2_n
+            // Input `buf1_k` contains first `k` received symbols from 0 .. k-1
+            this->fft->fft_inv(buf2_n, buf1_k);
 
-        this->fft_2k->fft(buf1_2k, output);
+            this->fft_2k->fft(buf1_2k, output);
+        }
 
         // multiply FFT(A) and buf2_2k
-        this->gf->mul_vec_to_vecp(A_fft_2k, buf1_2k, buf1_2k);
+        {
+            StageTimer timer(stats, Stage::HADAMARD);
+            this->gf->mul_vec_to_vecp(A_fft_2k, buf1_2k, buf1_2k);
+        }
 
-        this->fft_2k->ifft(buf2_2k, buf1_2k);
+        {
+            StageTimer timer(stats, Stage::FFT);
+            this->fft_2k->ifft(buf2_2k, buf1_2k);
+        }
 
         // negatize output
+        StageTimer timer(stats, Stage::HADAMARD);
         this->gf->neg(output);
     }
 
@@ -240,16 +271,166 @@ class RsFnt : public FecCode<T> {
         vec::Buffers<T>& words) override
     {
         if (this->type == FecType::SYSTEMATIC) {
-            decode_data(*enc_context, *inter_words, words);
-            vec::Buffers<T> _tmp(words, output);
-            vec::Buffers<T> _output(_tmp, *suffix_words);
-            this->fft->fft(_output, *inter_words);
+            encode_systematic(
+                *enc_context, *inter_words, *suffix_words, output, words);
+        } else {
+            StageTimer timer(this->stage_stats.get(), Stage::FFT);
+            this->fft->fft(output, words);
+        }
+        StageTimer timer(this->stage_stats.get(), Stage::POST_PROCESS);
+        encode_post_process(output, props, offset);
+    }
+
+    /**
+     * Encode Buffers of a systematic code
+     *
+     * Parities are the evaluations, after the `n_data` data, of the polynomial
+     * interpolating the data.
+     *
+     * @param plan FFT positions of the wanted parities, see `prune_outputs`,
+     * or nullptr to compute all of them
+     */
+    void encode_systematic(
+        DecodeContext<T>& context,
+        vec::Buffers<T>& inter,
+        vec::Buffers<T>& suffix,
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& words,
+        const std::vector<unsigned>* plan = nullptr)
+    {
+        decode_data(context, inter, words);
+        vec::Buffers<T> _tmp(words, output);
+        vec::Buffers<T> _output(_tmp, suffix);
+        StageTimer timer(this->stage_stats.get(), Stage::FFT);
+        if (plan) {
+            get_radix2().fft_pruned(_output, inter, *plan);
+        } else {
+            this->fft->fft(_output, inter);
+        }
+    }
+
+  protected:
+    bool is_parallel_safe() const override
+    {
+        return true;
+    }
+
+    bool is_update_supported() const override
+    {
+        return true;
+    }
+
+    bool is_repair_supported() const override
+    {
+        return true;
+    }
+
+    /**
+     * Prepare an encoding computing only the wanted outputs
+     *
+     * @param[out] plan FFT positions of the wanted outputs, i.e. shifted by
+     * `n_data` for systematic codes
+     */
+    bool prune_outputs(
+        const std::vector<bool>& wanted_idxs,
+        std::vector<unsigned>& plan) const override
+    {
+        const unsigned first =
+            (this->type == FecType::SYSTEMATIC) ? this->n_data : 0;
+
+        plan.clear();
+        for (unsigned i = 0; i < this->n_outputs; i++) {
+            if (wanted_idxs[i]) {
+                plan.push_back(first + i);
+            }
+        }
+        return plan.size() < this->n_outputs
+               && get_radix2().is_pruning_worth(this->n_data, plan);
+    }
+
+    void encode_pruned(
+        Workspace<T>* workspace,
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words,
+        const std::vector<unsigned>& plan) override
+    {
+        if (this->type == FecType::SYSTEMATIC) {
+            if (workspace) {
+                FntWorkspace& ws = static_cast<FntWorkspace&>(*workspace);
+                encode_systematic(
+                    *ws.enc_context,
+                    *ws.inter_words,
+                    *ws.suffix_words,
+                    output,
+                    words,
+                    &plan);
+            } else {
+                encode_systematic(
+                    *enc_context,
+                    *inter_words,
+                    *suffix_words,
+                    output,
+                    words,
+                    &plan);
+            }
+        } else {
+            StageTimer timer(this->stage_stats.get(), Stage::FFT);
+            get_radix2().fft_pruned(output, words, plan);
+        }
+        StageTimer timer(this->stage_stats.get(), Stage::POST_PROCESS);
+        encode_post_process(output, props, offset);
+    }
+
+    std::unique_ptr<Workspace<T>> alloc_workspace() override
+    {
+        std::unique_ptr<FntWorkspace> workspace =
+            std::make_unique<FntWorkspace>();
+
+        if (this->type == FecType::SYSTEMATIC) {
+            workspace->inter_words =
+                std::make_unique<vec::Buffers<T>>(this->n_data, this->pkt_size);
+            workspace->suffix_words = std::make_unique<vec::Buffers<T>>(
+                this->n - this->n_data - this->n_outputs, this->pkt_size);
+
+            std::vector<Properties> dummy_props;
+            workspace->enc_context = this->init_context_dec(
+                *enc_frag_ids,
+                dummy_props,
+                this->pkt_size,
+                workspace->inter_words.get());
+
+            workspace->dec_inter_codeword =
+                std::make_unique<vec::Buffers<T>>(this->n, this->pkt_size);
+        }
+        return workspace;
+    }
+
+    void encode_with_workspace(
+        Workspace<T>& workspace,
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        if (this->type == FecType::SYSTEMATIC) {
+            FntWorkspace& ws = static_cast<FntWorkspace&>(workspace);
+            encode_systematic(
+                *ws.enc_context,
+                *ws.inter_words,
+                *ws.suffix_words,
+                output,
+                words);
         } else {
+            StageTimer timer(this->stage_stats.get(), Stage::FFT);
             this->fft->fft(output, words);
         }
+        StageTimer timer(this->stage_stats.get(), Stage::POST_PROCESS);
         encode_post_process(output, props, offset);
     }
 
+  public:
     void encode_post_process(
         vec::Buffers<T>& output,
         std::vector<Properties>& props,
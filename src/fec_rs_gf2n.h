@@ -31,6 +31,12 @@
 #ifndef __QUAD_FEC_RS_GF2N_H__
 #define __QUAD_FEC_RS_GF2N_H__
 
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "fec_base.h"
 #include "gf_bin_ext.h"
 #include "vec_matrix.h"
@@ -43,6 +49,11 @@ enum class RsMatrixType { VANDERMONDE, CAUCHY };
 
 /** Reed-Solomon (RS) Erasure code over GF(2<sup>n</sup>) (Cauchy or
  *  Vandermonde).
+ *
+ * The inverted decoding matrices are cached, keyed by the fragments used to
+ * decode, so that decoding again with an erasure pattern only applies its
+ * matrix. The cache is bounded, the least recently used pattern being evicted,
+ * and patterns precomputed by `precompute_decode_matrices` are always kept.
  */
 template <typename T>
 class RsGf2n : public FecCode<T> {
@@ -50,14 +61,23 @@ class RsGf2n : public FecCode<T> {
     using FecCode<T>::decode;
     using FecCode<T>::encode;
 
+    /// Number of decoding matrices kept by default
+    static constexpr size_t DEFAULT_DECODE_MATRIX_CAPACITY = 16;
+
     RsMatrixType mat_type;
 
     RsGf2n(
         unsigned word_size,
         unsigned n_data,
         unsigned n_parities,
-        RsMatrixType type)
-        : FecCode<T>(FecType::SYSTEMATIC, word_size, n_data, n_parities)
+        RsMatrixType type,
+        size_t pkt_size = 8)
+        : FecCode<T>(
+              FecType::SYSTEMATIC,
+              word_size,
+              n_data,
+              n_parities,
+              pkt_size)
     {
         mat_type = type;
         this->fec_init();
@@ -91,9 +111,7 @@ class RsGf2n : public FecCode<T> {
             mat->vandermonde_suitable_for_ec();
         }
 
-        // has to be a n_data*n_data invertible square matrix
-        decode_mat = std::unique_ptr<vec::Matrix<T>>(new vec::Matrix<T>(
-            *(this->gf), mat->get_n_cols(), mat->get_n_cols()));
+        dec_rows.resize(this->n_data);
     }
 
     int get_n_outputs() override
@@ -110,28 +128,117 @@ class RsGf2n : public FecCode<T> {
         mat->mul(&output, &words);
     }
 
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        mat->mul(&output, &words);
+    }
+
     void decode_add_data(int fragment_index, int row) override
     {
-        // for each data available generate the corresponding identity
-        for (int j = 0; j < mat->get_n_cols(); j++) {
-            if (row == j)
-                decode_mat->set(fragment_index, j, 1);
-            else
-                decode_mat->set(fragment_index, j, 0);
-        }
+        dec_rows[fragment_index] = row;
     }
 
     void decode_add_parities(int fragment_index, int row) override
     {
-        // copy corresponding row in vandermonde matrix
-        for (int j = 0; j < mat->get_n_cols(); j++) {
-            decode_mat->set(fragment_index, j, mat->get(row, j));
-        }
+        dec_rows[fragment_index] = this->n_data + row;
     }
 
     void decode_build() override
     {
-        decode_mat->inv();
+        std::lock_guard<std::mutex> lock(dec_mats_mutex);
+
+        auto fixed = fixed_dec_mats.find(dec_rows);
+        if (fixed != fixed_dec_mats.end()) {
+            decode_mat = fixed->second;
+            dec_mats_hits++;
+            return;
+        }
+        for (auto it = dec_mats.begin(); it != dec_mats.end(); ++it) {
+            if (it->first == dec_rows) {
+                // Move the pattern to the front as the most recently used.
+                dec_mats.splice(dec_mats.begin(), dec_mats, it);
+                decode_mat = it->second;
+                dec_mats_hits++;
+                return;
+            }
+        }
+        dec_mats_misses++;
+
+        decode_mat = build_decode_matrix(dec_rows);
+        if (dec_mats_capacity == 0) {
+            return;
+        }
+        if (dec_mats.size() == dec_mats_capacity) {
+            dec_mats.pop_back();
+        }
+        dec_mats.emplace_front(dec_rows, decode_mat);
+    }
+
+    /** Set the number of erasure patterns whose decoding matrices are kept,
+     * besides the precomputed ones.
+     *
+     * @param capacity maximum number of patterns kept (0 disables the cache)
+     */
+    void set_decode_matrix_capacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(dec_mats_mutex);
+        dec_mats_capacity = capacity;
+        while (dec_mats.size() > capacity) {
+            dec_mats.pop_back();
+        }
+    }
+
+    size_t get_decode_matrix_capacity() const
+    {
+        return dec_mats_capacity;
+    }
+
+    /** Return the number of decodings that reused a decoding matrix. */
+    uint64_t get_decode_matrix_hits() const
+    {
+        return dec_mats_hits;
+    }
+
+    /** Return the number of decodings that had to invert a matrix. */
+    uint64_t get_decode_matrix_misses() const
+    {
+        return dec_mats_misses;
+    }
+
+    /** Precompute the decoding matrices of all the patterns of one and two
+     * lost fragments.
+     *
+     * The fragments used to decode are chosen as the decoding does: the
+     * available data fragments, then the first available parities.
+     */
+    void precompute_decode_matrices()
+    {
+        const unsigned n_frags = this->n_data + this->n_parities;
+
+        for (unsigned lost0 = 0; lost0 < n_frags; ++lost0) {
+            for (unsigned lost1 = lost0; lost1 < n_frags; ++lost1) {
+                std::vector<int> rows;
+                for (unsigned i = 0;
+                     i < n_frags && rows.size() < this->n_data;
+                     ++i) {
+                    if (i != lost0 && i != lost1) {
+                        rows.push_back(i);
+                    }
+                }
+                // Nothing to decode if no data fragment is lost.
+                if (lost0 >= this->n_data || rows.size() < this->n_data) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(dec_mats_mutex);
+                if (fixed_dec_mats.find(rows) == fixed_dec_mats.end()) {
+                    fixed_dec_mats.emplace(rows, build_decode_matrix(rows));
+                }
+            }
+        }
     }
 
     void decode(
@@ -144,6 +251,16 @@ class RsGf2n : public FecCode<T> {
         decode_mat->mul(&output, &words);
     }
 
+    void decode(
+        DecodeContext<T>&,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        decode_mat->mul(&output, &words);
+    }
+
     std::unique_ptr<DecodeContext<T>> init_context_dec(
         vec::Vector<T>&,
         std::vector<Properties>&,
@@ -155,10 +272,56 @@ class RsGf2n : public FecCode<T> {
     }
 
   private:
+    /** Build the inverse of the matrix made of the rows of the systematic
+     * generator matrix given by `rows`, i.e. identity rows for data fragments
+     * and rows of `mat` for parities.
+     */
+    std::shared_ptr<vec::Matrix<T>>
+    build_decode_matrix(const std::vector<int>& rows)
+    {
+        const int n_cols = mat->get_n_cols();
+        // has to be a n_data*n_data invertible square matrix
+        std::shared_ptr<vec::Matrix<T>> dec =
+            std::make_shared<vec::Matrix<T>>(*(this->gf), n_cols, n_cols);
+
+        for (int i = 0; i < n_cols; i++) {
+            const int row = rows[i];
+            for (int j = 0; j < n_cols; j++) {
+                if (row < n_cols) {
+                    // identity for an available data fragment
+                    dec->set(i, j, row == j ? 1 : 0);
+                } else {
+                    // corresponding row in the generator matrix
+                    dec->set(i, j, mat->get(row - n_cols, j));
+                }
+            }
+        }
+        dec->inv();
+
+        return dec;
+    }
+
     std::unique_ptr<vec::Matrix<T>> mat = nullptr;
-    std::unique_ptr<vec::Matrix<T>> decode_mat = nullptr;
+    std::shared_ptr<vec::Matrix<T>> decode_mat = nullptr;
+
+    // Fragments used by the coming decoding, as rows of the systematic
+    // generator matrix (see `build_decode_matrix`).
+    std::vector<int> dec_rows;
+
+    // Cached decoding matrices, from the most to the least recently used,
+    // and precomputed ones.
+    std::mutex dec_mats_mutex;
+    size_t dec_mats_capacity = DEFAULT_DECODE_MATRIX_CAPACITY;
+    std::list<std::pair<std::vector<int>, std::shared_ptr<vec::Matrix<T>>>>
+        dec_mats;
+    std::map<std::vector<int>, std::shared_ptr<vec::Matrix<T>>> fixed_dec_mats;
+    uint64_t dec_mats_hits = 0;
+    uint64_t dec_mats_misses = 0;
 };
 
+template <typename T>
+constexpr size_t RsGf2n<T>::DEFAULT_DECODE_MATRIX_CAPACITY;
+
 } // namespace fec
 } // namespace quadiron
 
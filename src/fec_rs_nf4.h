@@ -31,21 +31,107 @@
 #ifndef __QUAD_FEC_RS_NF4_H__
 #define __QUAD_FEC_RS_NF4_H__
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "fec_base.h"
+#include "fec_context.h"
 #include "fft_2n.h"
 #include "gf_base.h"
 #include "gf_nf4.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 
 namespace quadiron {
 namespace fec {
 
-/** Reed-Solomon (RS) Erasure code over `n` GF(F<sub>4</sub>). */
+/** Decoding context of fec::RsNf4 for buffers
+ *
+ * The `n` GF(F<sub>4</sub>) lanes share the fragments and hence the
+ * interpolation context: it is built once over GF(F<sub>4</sub>) and applied
+ * to the planar lanes in turn (see gf::NF4::split_lanes).
+ */
+template <typename T>
+class Nf4DecodeContext : public DecodeContext<T> {
+  public:
+    Nf4DecodeContext(
+        const gf::NF4<T>& gf,
+        fft::FourierTransform<T>& fft,
+        fft::FourierTransform<T>& fft_2k,
+        const vec::Vector<T>& fragments_ids,
+        std::vector<Properties>& input_props,
+        const vec::Vector<T>& vx,
+        const int k,
+        const int n,
+        const size_t size,
+        vec::Buffers<T>* output,
+        unsigned n_lanes,
+        fft::FourierTransform<uint32_t>& lane_fft,
+        fft::FourierTransform<uint32_t>& lane_fft_2k)
+        : DecodeContext<T>(
+              gf,
+              fft,
+              fft_2k,
+              fragments_ids,
+              input_props,
+              vx,
+              k,
+              n,
+              -1,
+              size,
+              output)
+    {
+        if (size == 0) {
+            return;
+        }
+        const gf::Field<uint32_t>& sub_field = gf.get_sub_field();
+
+        // The elements of `vx` are replicated: their first lane is enough.
+        vec::Vector<uint32_t> lane_ids(sub_field, k);
+        vec::Vector<uint32_t> lane_vx(sub_field, k);
+        for (int i = 0; i < k; ++i) {
+            lane_ids.set(i, narrow_cast<uint32_t>(fragments_ids.get(i)));
+            lane_vx.set(i, narrow_cast<uint32_t>(vx.get(i)));
+        }
+
+        lane_output = std::make_unique<vec::Buffers<uint32_t>>(k, size);
+        lane_context = std::make_unique<DecodeContext<uint32_t>>(
+            sub_field,
+            lane_fft,
+            lane_fft_2k,
+            lane_ids,
+            input_props,
+            lane_vx,
+            k,
+            n,
+            -1,
+            size,
+            lane_output.get());
+        for (unsigned i = 0; i < n_lanes; ++i) {
+            lane_words.push_back(
+                std::make_unique<vec::Buffers<uint32_t>>(k, size));
+        }
+    }
+
+    // Declared first, as `lane_context` refers to it.
+    std::unique_ptr<vec::Buffers<uint32_t>> lane_output = nullptr;
+    std::unique_ptr<DecodeContext<uint32_t>> lane_context = nullptr;
+    // Received symbols, then decoded ones, of each lane
+    std::vector<std::unique_ptr<vec::Buffers<uint32_t>>> lane_words;
+};
+
+/** Reed-Solomon (RS) Erasure code over `n` GF(F<sub>4</sub>).
+ *
+ * The Buffers versions of encoding and decoding work on the planar layout of
+ * the elements: each lane is coded by its own FNT over GF(F<sub>4</sub>),
+ * instead of packing and unpacking every element.
+ */
 template <typename T>
 class RsNf4 : public FecCode<T> {
   public:
+    using FecCode<T>::encode_post_process;
+
     RsNf4(
         unsigned word_size,
         unsigned n_data,
@@ -93,6 +179,16 @@ class RsNf4 : public FecCode<T> {
         unsigned len_2k = this->gf->get_code_len_high_compo(2 * this->n_data);
         this->fft_2k = std::unique_ptr<fft::Radix2<T>>(
             new fft::Radix2<T>(*ngff4, len_2k, len_2k, this->pkt_size));
+
+        // FFTs of the planar lanes, with the same roots
+        lane_fft = std::unique_ptr<fft::Radix2<uint32_t>>(
+            new fft::Radix2<uint32_t>(
+                *sub_field, this->n, m, this->pkt_size));
+        unsigned lane_len_2k =
+            sub_field->get_code_len_high_compo(2 * this->n_data);
+        lane_fft_2k = std::unique_ptr<fft::Radix2<uint32_t>>(
+            new fft::Radix2<uint32_t>(
+                *sub_field, lane_len_2k, lane_len_2k, this->pkt_size));
     }
 
     inline void init_others() override
@@ -110,6 +206,14 @@ class RsNf4 : public FecCode<T> {
         for (unsigned i = 0; i < this->n; i++) {
             this->r_powers->set(i, ngff4->exp(this->r, i));
         }
+
+        for (int i = 0; i < gf_n; i++) {
+            enc_lane_words.push_back(std::make_unique<vec::Buffers<uint32_t>>(
+                this->n_data, this->pkt_size));
+            enc_lane_output.push_back(
+                std::make_unique<vec::Buffers<uint32_t>>(
+                    this->n, this->pkt_size));
+        }
     }
 
     int get_n_outputs() override
@@ -171,6 +275,23 @@ class RsNf4 : public FecCode<T> {
     const gf::Field<uint32_t>* sub_field;
     gf::NF4<T>* ngff4;
     int gf_n;
+    std::unique_ptr<fft::Radix2<uint32_t>> lane_fft = nullptr;
+    std::unique_ptr<fft::Radix2<uint32_t>> lane_fft_2k = nullptr;
+    // Planar lanes of the words and codewords of the Buffers `encode`
+    std::vector<std::unique_ptr<vec::Buffers<uint32_t>>> enc_lane_words;
+    std::vector<std::unique_ptr<vec::Buffers<uint32_t>>> enc_lane_output;
+
+    /// Pointers to the `i`-th buffer of each lane of `lanes`
+    std::vector<uint32_t*> lanes_at(
+        const std::vector<std::unique_ptr<vec::Buffers<uint32_t>>>& lanes,
+        unsigned i) const
+    {
+        std::vector<uint32_t*> ptrs(gf_n);
+        for (int l = 0; l < gf_n; ++l) {
+            ptrs[l] = lanes[l]->get(i);
+        }
+        return ptrs;
+    }
 
   protected:
     std::unique_ptr<DecodeContext<T>> init_context_dec(
@@ -199,8 +320,8 @@ class RsNf4 : public FecCode<T> {
         }
 
         std::unique_ptr<DecodeContext<T>> context =
-            std::unique_ptr<DecodeContext<T>>(new DecodeContext<T>(
-                *(this->gf),
+            std::unique_ptr<DecodeContext<T>>(new Nf4DecodeContext<T>(
+                *ngff4,
                 *(this->fft),
                 *(this->fft_2k),
                 fragments_ids,
@@ -208,9 +329,11 @@ class RsNf4 : public FecCode<T> {
                 vx,
                 k,
                 this->n,
-                -1,
                 size,
-                output));
+                output,
+                gf_n,
+                *lane_fft,
+                *lane_fft_2k));
 
         return context;
     }
@@ -259,31 +382,29 @@ class RsNf4 : public FecCode<T> {
         vec::Buffers<T>& words) override
     {
         for (unsigned i = 0; i < this->n_data; ++i) {
-            T* chunk = words.get(i);
-            for (size_t j = 0; j < this->pkt_size; ++j) {
-                chunk[j] = ngff4->pack(chunk[j]);
-            }
+            const std::vector<uint32_t*> lanes = lanes_at(enc_lane_words, i);
+            ngff4->split_lanes(words.get(i), lanes.data(), this->pkt_size);
+        }
+        for (int l = 0; l < gf_n; ++l) {
+            lane_fft->fft(*enc_lane_output[l], *enc_lane_words[l]);
         }
-        this->fft->fft(output, words);
-        encode_post_process(output, props, offset);
-    }
 
-    void encode_post_process(
-        vec::Buffers<T>& output,
-        std::vector<Properties>& props,
-        off_t offset) override
-    {
-        size_t size = output.get_size();
-        GroupedValues<T> true_val;
+        // merge the lanes and mark their values equal to 65536
         for (unsigned frag_id = 0; frag_id < this->code_len; ++frag_id) {
-            T* chunk = output.get(frag_id);
-            for (size_t symb_id = 0; symb_id < size; symb_id++) {
-                ngff4->unpack(chunk[symb_id], true_val);
-                if (true_val.flag > 0) {
-                    const off_t loc = offset + symb_id;
-                    props[frag_id].add(loc, true_val.flag);
+            const std::vector<uint32_t*> lanes =
+                lanes_at(enc_lane_output, frag_id);
+            ngff4->merge_lanes(
+                lanes.data(), output.get(frag_id), this->pkt_size);
+            for (size_t symb_id = 0; symb_id < this->pkt_size; ++symb_id) {
+                uint32_t flag = 0;
+                for (int l = 0; l < gf_n; ++l) {
+                    if (lanes[l][symb_id] == 65536) {
+                        flag |= (1 << l);
+                    }
+                }
+                if (flag > 0) {
+                    props[frag_id].add(offset + symb_id, flag);
                 }
-                chunk[symb_id] = true_val.values;
             }
         }
     }
@@ -294,24 +415,27 @@ class RsNf4 : public FecCode<T> {
         off_t offset,
         vec::Buffers<T>& words) override
     {
+        Nf4DecodeContext<T>& ctx = static_cast<Nf4DecodeContext<T>&>(context);
         const vec::Vector<T>& fragments_ids = context.get_fragments_id();
+        const off_t offset_max = offset + this->pkt_size;
+
         for (unsigned i = 0; i < this->n_data; ++i) {
             const int frag_id = fragments_ids.get(i);
-            T* chunk = words.get(i);
-
-            // pack marked symbols
-            for (size_t index = 0; index < this->pkt_size; ++index) {
-                if (props[frag_id].is_marked(
-                        context.props_indices[frag_id], offset + index)) {
-                    // pack marked symbol
-                    chunk[index] = ngff4->pack(
-                        chunk[index],
-                        props[frag_id].marker(context.props_indices[frag_id]));
-                    context.props_indices.at(frag_id)++;
-                } else {
-                    // pack un-marked symbol
-                    chunk[index] = ngff4->pack(chunk[index]);
+            const std::vector<uint32_t*> lanes = lanes_at(ctx.lane_words, i);
+            ngff4->split_lanes(words.get(i), lanes.data(), this->pkt_size);
+
+            // restore the marked values, i.e. 65536
+            while (props[frag_id].in_range(
+                context.props_indices.at(frag_id), offset, offset_max)) {
+                const size_t idx = context.props_indices.at(frag_id);
+                const size_t j = props[frag_id].location(idx) - offset;
+                const uint32_t flag = props[frag_id].marker(idx);
+                for (int l = 0; l < gf_n; ++l) {
+                    if (flag & (1 << l)) {
+                        lanes[l][j] = 65536;
+                    }
                 }
+                context.props_indices.at(frag_id)++;
             }
         }
     }
@@ -319,17 +443,30 @@ class RsNf4 : public FecCode<T> {
     void decode_apply(
         DecodeContext<T>& context,
         vec::Buffers<T>& output,
-        vec::Buffers<T>& words) override
+        vec::Buffers<T>& /* words */) override
     {
-        // decode_apply: do the same thing as in fec_base
-        FecCode<T>::decode_apply(context, output, words);
-        // unpack decoded symbols
-        for (unsigned i = 0; i < this->n_data; ++i) {
-            T* chunk = output.get(i);
-            for (unsigned j = 0; j < this->pkt_size; ++j) {
-                chunk[j] = ngff4->unpack(chunk[j]).values;
+        // the words were split into the lanes by `decode_prepare`
+        Nf4DecodeContext<T>& ctx = static_cast<Nf4DecodeContext<T>&>(context);
+
+        for (int l = 0; l < gf_n; ++l) {
+            vec::Buffers<uint32_t>& lane_words = *ctx.lane_words[l];
+            lagrange_interpolate(
+                *sub_field,
+                *lane_fft,
+                *lane_fft_2k,
+                *ctx.lane_context,
+                *ctx.lane_output,
+                lane_words,
+                this->stage_stats.get());
+            // the received symbols of the lane are no longer needed
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                lane_words.copy(i, ctx.lane_output->get(i));
             }
         }
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            const std::vector<uint32_t*> lanes = lanes_at(ctx.lane_words, i);
+            ngff4->merge_lanes(lanes.data(), output.get(i), this->pkt_size);
+        }
     }
 };
 
@@ -0,0 +1,157 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FEC_STATS_H__
+#define __QUAD_FEC_STATS_H__
+
+#include <atomic>
+#include <cstdint>
+
+#include "misc.h"
+
+namespace quadiron {
+namespace fec {
+
+/** Stages of the encoding and decoding timed by `StageStats` */
+enum class Stage : unsigned {
+    /// Packing of the bytes read into words
+    PACK = 0,
+    /// Unpacking of the words computed into bytes
+    UNPACK,
+    /// Forward and inverse FFT
+    FFT,
+    /// Element-wise operations on vectors (Hadamard products, negation)
+    HADAMARD,
+    /// Detection and marking of the out-of-range values of the encoding
+    POST_PROCESS,
+    /// Sorting, merging and applying properties
+    PROPS,
+    /// Building of the decoding contexts
+    CONTEXT_BUILD,
+    /// Copies between the blocks and the staging buffers
+    COPY,
+};
+
+/// Number of stages
+constexpr unsigned N_STAGES = 8;
+
+/** Return the name of a stage */
+inline const char* get_stage_name(Stage stage)
+{
+    static const char* const names[N_STAGES] = {
+        "pack",
+        "unpack",
+        "fft",
+        "hadamard",
+        "post_process",
+        "props",
+        "context_build",
+        "copy",
+    };
+    return names[static_cast<unsigned>(stage)];
+}
+
+/** Cycles spent in each stage (see `hw_timer`), and number of times each
+ * stage was run
+ *
+ * Counters are updated atomically as ranges of packets may be processed
+ * concurrently.
+ */
+class StageStats {
+  public:
+    StageStats()
+    {
+        reset();
+    }
+
+    void add(Stage stage, uint64_t n_cycles)
+    {
+        const unsigned i = static_cast<unsigned>(stage);
+        cycles[i].fetch_add(n_cycles, std::memory_order_relaxed);
+        calls[i].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t get_cycles(Stage stage) const
+    {
+        return cycles[static_cast<unsigned>(stage)].load(
+            std::memory_order_relaxed);
+    }
+
+    uint64_t get_calls(Stage stage) const
+    {
+        return calls[static_cast<unsigned>(stage)].load(
+            std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        for (unsigned i = 0; i < N_STAGES; ++i) {
+            cycles[i].store(0, std::memory_order_relaxed);
+            calls[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+  private:
+    std::atomic<uint64_t> cycles[N_STAGES];
+    std::atomic<uint64_t> calls[N_STAGES];
+};
+
+/** Time the enclosing scope as a stage
+ *
+ * Nothing is timed if no statistics are given, so that disabled statistics
+ * only cost a test.
+ */
+class StageTimer {
+  public:
+    StageTimer(StageStats* stats, Stage stage)
+        : stats(stats), stage(stage), start(stats ? hw_timer() : 0)
+    {
+    }
+
+    ~StageTimer()
+    {
+        if (stats) {
+            stats->add(stage, hw_timer() - start);
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+  private:
+    StageStats* stats;
+    Stage stage;
+    uint64_t start;
+};
+
+} // namespace fec
+} // namespace quadiron
+
+#endif
@@ -37,9 +37,6 @@
 
 #ifdef QUADIRON_USE_SIMD
 
-#include "simd.h"
-#include "simd/simd.h"
-
 namespace quadiron {
 namespace fec {
 
@@ -53,8 +50,10 @@ void RsFnt<uint16_t>::encode_post_process(
     uint16_t threshold = this->gf->card_minus_one();
     unsigned code_len = this->n_outputs;
 
-    simd::encode_post_process(
-        output, props, offset, code_len, threshold, simd_vec_len);
+    if (simd_kernels != nullptr) {
+        simd_kernels->encode_post_process(
+            output, props, offset, code_len, threshold, simd_vec_len);
+    }
 
     if (simd_trailing_len > 0) {
         for (unsigned i = 0; i < code_len; ++i) {
@@ -78,8 +77,10 @@ void RsFnt<uint32_t>::encode_post_process(
     const uint32_t threshold = this->gf->card_minus_one();
     const unsigned code_len = this->n_outputs;
 
-    simd::encode_post_process(
-        output, props, offset, code_len, threshold, simd_vec_len);
+    if (simd_kernels != nullptr) {
+        simd_kernels->encode_post_process(
+            output, props, offset, code_len, threshold, simd_vec_len);
+    }
 
     if (simd_trailing_len > 0) {
         for (unsigned i = 0; i < code_len; ++i) {
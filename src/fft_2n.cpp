@@ -37,8 +37,6 @@
 
 #ifdef QUADIRON_USE_SIMD
 
-#include "simd.h"
-
 namespace quadiron {
 namespace fft {
 
@@ -54,8 +52,10 @@ void Radix2<uint16_t>::butterfly_ct_two_layers_step(
     const uint16_t r3 = vec_W[coefIndex / 2 + this->n / 4];
 
     // perform vector operations
-    simd::butterfly_ct_two_layers_step(
-        buf, r1, r2, r3, start, m, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_ct_two_layers_step(
+            buf, r1, r2, r3, start, m, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -72,7 +72,10 @@ void Radix2<uint16_t>::butterfly_ct_step(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_ct_step(buf, r, start, m, step, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_ct_step(
+            buf, r, start, m, step, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -89,7 +92,10 @@ void Radix2<uint16_t>::butterfly_gs_step(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step(buf, coef, start, m, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_gs_step(
+            buf, coef, start, m, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -106,7 +112,10 @@ void Radix2<uint16_t>::butterfly_gs_step_simple(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step_simple(buf, coef, start, m, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_gs_step_simple(
+            buf, coef, start, m, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -114,6 +123,29 @@ void Radix2<uint16_t>::butterfly_gs_step_simple(
     }
 }
 
+template <>
+void Radix2<uint16_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    const unsigned coefIndex = start * this->n / m / 2;
+    const uint16_t r1 = vec_inv_W[coefIndex];
+    const uint16_t r2 = vec_inv_W[coefIndex / 2];
+    const uint16_t r3 = vec_inv_W[coefIndex / 2 + this->n / 4];
+
+    // perform vector operations
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_gs_two_layers_step(
+            buf, r1, r2, r3, start, m, simd_vec_len, card);
+    }
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_two_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
 template <>
 void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     vec::Buffers<uint32_t>& buf,
@@ -126,8 +158,10 @@ void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     const uint32_t r3 = vec_W[coefIndex / 2 + this->n / 4];
 
     // perform vector operations
-    simd::butterfly_ct_two_layers_step(
-        buf, r1, r2, r3, start, m, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_ct_two_layers_step(
+            buf, r1, r2, r3, start, m, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -144,7 +178,10 @@ void Radix2<uint32_t>::butterfly_ct_step(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_ct_step(buf, r, start, m, step, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_ct_step(
+            buf, r, start, m, step, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -161,7 +198,10 @@ void Radix2<uint32_t>::butterfly_gs_step(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step(buf, coef, start, m, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_gs_step(
+            buf, coef, start, m, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -178,7 +218,10 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     unsigned step)
 {
     // perform vector operations
-    simd::butterfly_gs_step_simple(buf, coef, start, m, simd_vec_len, card);
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_gs_step_simple(
+            buf, coef, start, m, simd_vec_len, card);
+    }
 
     // for last elements, perform as non-SIMD method
     if (simd_trailing_len > 0) {
@@ -186,6 +229,29 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     }
 }
 
+template <>
+void Radix2<uint32_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    const unsigned coefIndex = start * this->n / m / 2;
+    const uint32_t r1 = vec_inv_W[coefIndex];
+    const uint32_t r2 = vec_inv_W[coefIndex / 2];
+    const uint32_t r3 = vec_inv_W[coefIndex / 2 + this->n / 4];
+
+    // perform vector operations
+    if (simd_kernels != nullptr) {
+        simd_kernels->butterfly_gs_two_layers_step(
+            buf, r1, r2, r3, start, m, simd_vec_len, card);
+    }
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_two_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
 } // namespace fft
 } // namespace quadiron
 
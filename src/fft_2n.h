@@ -31,11 +31,14 @@
 #ifndef __QUAD_FFT_2N_H__
 #define __QUAD_FFT_2N_H__
 
+#include <algorithm>
+
 #include "arith.h"
 #include "fft_2.h"
 #include "fft_base.h"
 #include "fft_single.h"
 #include "gf_base.h"
+#include "simd_dispatch.h"
 #include "vec_vector.h"
 #include "vec_zero_ext.h"
 
@@ -84,10 +87,24 @@ class Radix2 : public FourierTransform<T> {
     void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
     void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
 
+    void fft_pruned(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        const std::vector<unsigned>& outputs);
+    bool is_pruning_worth(
+        size_t input_len,
+        const std::vector<unsigned>& outputs) const;
+
     OpCounter fft_op_counter(size_t input_len) override;
     OpCounter ifft_op_counter(size_t input_len) override;
 
   private:
+    unsigned get_group_len(size_t input_len) const;
+    unsigned scramble(vec::Buffers<T>& output, vec::Buffers<T>& input);
+    static bool is_first_residue(
+        const std::vector<unsigned>& outputs,
+        size_t index,
+        unsigned m);
     void init_bitrev();
     void bit_rev_permute(vec::Vector<T>& vec);
     void bit_rev_permute(vec::Buffers<T>& vec);
@@ -113,6 +130,14 @@ class Radix2 : public FourierTransform<T> {
         unsigned start,
         unsigned m,
         unsigned step);
+    void butterfly_gs_two_layers_step(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m);
+    void butterfly_gs_layers(
+        vec::Buffers<T>& buf,
+        unsigned m,
+        unsigned min_m);
 
     // Only used for non-vectorized elements
     void butterfly_ct_two_layers_step_slow(
@@ -141,6 +166,11 @@ class Radix2 : public FourierTransform<T> {
         unsigned m,
         unsigned step,
         size_t offset = 0);
+    void butterfly_gs_two_layers_step_slow(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        size_t offset = 0);
 
     unsigned data_len; // number of real input elements
     T card;
@@ -149,8 +179,10 @@ class Radix2 : public FourierTransform<T> {
     T inv_w;
     size_t pkt_size;
     size_t buf_size;
+    unsigned block_len; // see `fft` and `fft_inv` on buffers
 
-    // Indices used for accelerated functions
+    // Kernels and indices used for accelerated functions
+    const simd::FntKernels<T>* simd_kernels;
     size_t simd_vec_len;
     size_t simd_trailing_len;
     size_t simd_offset;
@@ -159,8 +191,16 @@ class Radix2 : public FourierTransform<T> {
     std::unique_ptr<vec::Vector<T>> W = nullptr;
     std::unique_ptr<vec::Vector<T>> inv_W = nullptr;
     T* vec_W;
+    T* vec_inv_W;
 };
 
+/// Minimal code length from which the layers are performed by blocks.
+static constexpr unsigned FFT_BLOCKING_MIN_LEN = 256;
+
+/// Maximal size in bytes of a block of buffers processed while it stays in
+/// the cache.
+static constexpr size_t FFT_BLOCK_BYTES = 256 * 1024;
+
 /** Initialize the FFT object.
  *
  * n-th root will be constructed with primitive root
@@ -193,6 +233,7 @@ Radix2<T>::Radix2(const gf::Field<T>& gf, int n, int data_len, size_t pkt_size)
     gf.compute_omegas(*inv_W, n, inv_w);
 
     vec_W = W->get_mem();
+    vec_inv_W = inv_W->get_mem();
 
     card = this->gf->card();
     card_minus_one = this->gf->card_minus_one();
@@ -200,11 +241,26 @@ Radix2<T>::Radix2(const gf::Field<T>& gf, int n, int data_len, size_t pkt_size)
     rev = std::unique_ptr<T[]>(new T[n]);
     init_bitrev();
 
-    // Indices used for accelerated functions
-    const unsigned ratio = simd::countof<T>();
-    simd_vec_len = this->pkt_size / ratio;
+    // Kernels and indices used for accelerated functions: without kernels
+    // every element is processed by the non-SIMD method.
+    simd_kernels = simd::get_fnt_kernels<T>();
+    const unsigned ratio = simd_kernels == nullptr ? 0 : simd_kernels->countof;
+    simd_vec_len = ratio == 0 ? 0 : this->pkt_size / ratio;
     simd_trailing_len = this->pkt_size - simd_vec_len * ratio;
     simd_offset = simd_vec_len * ratio;
+
+    // Largest block of buffers fitting in cache, none (0) if all of them fit
+    block_len = 0;
+    if (static_cast<unsigned>(n) >= FFT_BLOCKING_MIN_LEN
+        && n * buf_size > FFT_BLOCK_BYTES) {
+        block_len = n / 2;
+        while (block_len >= 4 && block_len * buf_size > FFT_BLOCK_BYTES) {
+            block_len /= 2;
+        }
+        if (block_len < 4) {
+            block_len = 0;
+        }
+    }
 }
 
 template <typename T>
@@ -361,14 +417,148 @@ template <typename T>
 void Radix2<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
 {
     const unsigned len = this->n;
-    const unsigned input_len = input.get_n();
+    const unsigned group_len = scramble(output, input);
+
+    // ----------------------
+    // Two layers at a time
+    // ----------------------
+    unsigned m = group_len;
+    const unsigned end = len / 2;
+
+    // The first layers only mix buffers of a same block: they are performed
+    // block by block, while the block stays in cache.
+    if (block_len >= 4 * m) {
+        unsigned block_m = m;
+        while (4 * block_m <= block_len) {
+            block_m <<= 2;
+        }
+        for (unsigned b = 0; b < len; b += block_len) {
+            vec::Buffers<T> block(output, b, b + block_len);
+            for (unsigned k = m; k < block_m; k <<= 2) {
+                for (unsigned j = 0; j < k; ++j) {
+                    butterfly_ct_two_layers_step(block, j, k);
+                }
+            }
+        }
+        m = block_m;
+    }
+
+    for (; m < end; m <<= 2) {
+        for (unsigned j = 0; j < m; ++j) {
+            butterfly_ct_two_layers_step(output, j, m);
+        }
+    }
+    if (m < len) {
+        assert(m == end);
+        // perform the last butterfly operations
+        for (unsigned j = 0; j < m; ++j) {
+            const T r = W->get(j);
+            butterfly_ct_step(output, r, j, m, len);
+        }
+    }
+}
 
+/** Perform decimation-in-time FFT computing only some outputs
+ *
+ * In the last layer, output `k` is computed by the butterfly on positions `k
+ * mod n/2` and `k mod n/2 + n/2`. More generally, the butterfly of a layer
+ * of half-size `m` on positions `j` and `j + m` (modulo `2m`) only leads to
+ * outputs `k` such that `k mod m == j`. Other butterflies are skipped, hence
+ * computing `w` outputs takes O(N*log(w)) operations instead of O(N*logN).
+ *
+ * @note: residues are deduplicated in O(w^2) by layer, which suits a few
+ * outputs (see `is_pruning_worth`)
+ *
+ * @param output - output buffers, entries not in `outputs` are undefined
+ * @param input - input buffers
+ * @param outputs - indices of the wanted outputs
+ */
+template <typename T>
+void Radix2<T>::fft_pruned(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    const std::vector<unsigned>& outputs)
+{
+    const unsigned len = this->n;
+    const unsigned group_len = scramble(output, input);
+
+    for (unsigned m = group_len; m < len; m <<= 1) {
+        const unsigned ratio = len / (2 * m);
+        for (size_t idx = 0; idx < outputs.size(); ++idx) {
+            if (is_first_residue(outputs, idx, m)) {
+                const unsigned j = outputs[idx] & (m - 1);
+                butterfly_ct_step(output, W->get(j * ratio), j, m, 2 * m);
+            }
+        }
+    }
+}
+
+/** Check if `fft_pruned` is worth it for the given outputs
+ *
+ * The pruned FFT performs one layer at a time, against two for `fft`, hence
+ * it must save at least half of the butterflies.
+ *
+ * @param input_len - length of the input
+ * @param outputs - indices of the wanted outputs
+ *
+ * @return true if `fft_pruned` should be used rather than `fft`
+ */
+template <typename T>
+bool Radix2<T>::is_pruning_worth(
+    size_t input_len,
+    const std::vector<unsigned>& outputs) const
+{
+    const size_t len = this->n;
+
+    // Beyond sqrt(N) outputs, at least half of the butterflies are needed.
+    if (outputs.empty() || outputs.size() * outputs.size() > len) {
+        return false;
+    }
+
+    size_t n_butterflies = 0;
+    size_t n_pruned_butterflies = 0;
+    for (size_t m = get_group_len(input_len); m < len; m <<= 1) {
+        const size_t n_groups = len / (2 * m);
+        n_butterflies += n_groups * m;
+        for (size_t idx = 0; idx < outputs.size(); ++idx) {
+            if (is_first_residue(outputs, idx, m)) {
+                n_pruned_butterflies += n_groups;
+            }
+        }
+    }
+
+    return 2 * n_pruned_butterflies <= n_butterflies;
+}
+
+/**
+ * Return the size of the groups of the output initialized with the same input
+ *
+ * @param input_len - length of the input
+ */
+template <typename T>
+unsigned Radix2<T>::get_group_len(size_t input_len) const
+{
     assert(input_len > 0);
     assert(data_len > 0);
 
     // to support FFT on input vectors of length greater than from `data_len`
-    const unsigned group_len =
-        (input_len > data_len) ? len / input_len : len / data_len;
+    return (input_len > data_len) ? this->n / input_len : this->n / data_len;
+}
+
+/**
+ * Initialize the output of a decimation-in-time FFT
+ *
+ * @param output - output buffers
+ * @param input - input buffers
+ *
+ * @return the size of the groups of the output, i.e. the half-size of the
+ * first butterfly layer
+ */
+template <typename T>
+unsigned Radix2<T>::scramble(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    const unsigned input_len = input.get_n();
+    const unsigned group_len = get_group_len(input_len);
 
     const std::vector<T*>& i_mem = input.get_mem();
     const std::vector<T*>& o_mem = output.get_mem();
@@ -386,24 +576,29 @@ void Radix2<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
         }
     }
 
-    // ----------------------
-    // Two layers at a time
-    // ----------------------
-    unsigned m = group_len;
-    const unsigned end = len / 2;
-    for (; m < end; m <<= 2) {
-        for (unsigned j = 0; j < m; ++j) {
-            butterfly_ct_two_layers_step(output, j, m);
-        }
-    }
-    if (m < len) {
-        assert(m == end);
-        // perform the last butterfly operations
-        for (unsigned j = 0; j < m; ++j) {
-            const T r = W->get(j);
-            butterfly_ct_step(output, r, j, m, len);
+    return group_len;
+}
+
+/**
+ * Check if an output is the first one of its residue modulo `m`
+ *
+ * @param outputs - indices of outputs
+ * @param index - index of the output in `outputs`
+ * @param m - a power of 2
+ */
+template <typename T>
+bool Radix2<T>::is_first_residue(
+    const std::vector<unsigned>& outputs,
+    size_t index,
+    unsigned m)
+{
+    const unsigned residue = outputs[index] & (m - 1);
+    for (size_t i = 0; i < index; ++i) {
+        if ((outputs[i] & (m - 1)) == residue) {
+            return false;
         }
     }
+    return true;
 }
 
 // for each pair (P, Q) = (buf[i], buf[i + m]):
@@ -488,7 +683,7 @@ void Radix2<T>::butterfly_ct_step_slow(
     unsigned step,
     size_t offset)
 {
-    for (int i = start; i < this->n; i += step) {
+    for (int i = start; i < buf.get_n(); i += step) {
         T* a = buf.get(i);
         T* b = buf.get(i + m);
         // perform butterfly operation for Cooley-Tukey FFT algorithm
@@ -547,19 +742,55 @@ void Radix2<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
         }
     }
 
-    // Next, normal butterlfy GS is performed
-    for (; m >= 1; m /= 2) {
-        unsigned doubled_m = 2 * m;
-        for (unsigned j = 0; j < m; ++j) {
-            const T r = inv_W->get(j * len / doubled_m);
-            butterfly_gs_step(output, r, j, m, doubled_m);
+    // Next, normal butterfly GS is performed. The last layers only mix
+    // buffers of a same block: they are performed block by block, while the
+    // block stays in cache.
+    const unsigned block_m = std::min(m, block_len / 2);
+    if (block_m >= 2) {
+        if (m > block_m) {
+            butterfly_gs_layers(output, m, 2 * block_m);
+        }
+        for (unsigned b = 0; b < len; b += block_len) {
+            vec::Buffers<T> block(output, b, b + block_len);
+            butterfly_gs_layers(block, block_m, 1);
         }
+    } else if (m >= 1) {
+        butterfly_gs_layers(output, m, 1);
     }
 
     // 2nd reversion of elements of output to return its natural order
     bit_rev_permute(output);
 }
 
+/** Perform the normal GS layers of group sizes `m` down to `min_m`
+ *
+ * Layers are performed two at a time.
+ *
+ * @param buf - working buffers
+ * @param m - group size of the first layer, a power of 2
+ * @param min_m - group size of the last layer, a power of 2
+ */
+template <typename T>
+void Radix2<T>::butterfly_gs_layers(
+    vec::Buffers<T>& buf,
+    unsigned m,
+    unsigned min_m)
+{
+    for (; m >= 2 * min_m; m >>= 2) {
+        const unsigned half_m = m / 2;
+        for (unsigned j = 0; j < half_m; ++j) {
+            butterfly_gs_two_layers_step(buf, j, half_m);
+        }
+    }
+    if (m == min_m) {
+        const unsigned doubled_m = 2 * m;
+        for (unsigned j = 0; j < m; ++j) {
+            const T r = inv_W->get(j * this->n / doubled_m);
+            butterfly_gs_step(buf, r, j, m, doubled_m);
+        }
+    }
+}
+
 // for each pair (P, Q) = (buf[i], buf[i + m]):
 // Q = c * P
 template <typename T>
@@ -596,7 +827,7 @@ void Radix2<T>::butterfly_gs_step_slow(
     unsigned step,
     size_t offset)
 {
-    for (int i = start; i < this->n; i += step) {
+    for (int i = start; i < buf.get_n(); i += step) {
         T* a = buf.get(i);
         T* b = buf.get(i + m);
         // perform butterfly operation for Cooley-Tukey FFT algorithm
@@ -617,7 +848,7 @@ void Radix2<T>::butterfly_gs_step_simple_slow(
     unsigned step,
     size_t offset)
 {
-    for (int i = start; i < this->n; i += step) {
+    for (int i = start; i < buf.get_n(); i += step) {
         T* a = buf.get(i);
         T* b = buf.get(i + m);
         // perform butterfly operation for Cooley-Tukey FFT algorithm
@@ -627,6 +858,65 @@ void Radix2<T>::butterfly_gs_step_simple_slow(
     }
 }
 
+/**
+ * Butterfly GS on two-layers at a time
+ *
+ * For each quadruple
+ * (P, Q, R, S) = (buf[i], buf[i + m], buf[i + 2 * m], buf[i + 3 * m])
+ * First layer: butterfly on (P, R) and (Q, S) for step = 4 * m
+ *      coef r2 = inv_W[start * n / (4 * m)]
+ *      coef r3 = inv_W[(start + m) * n / (4 * m)]
+ *      P = P + R
+ *      R = r2 * (P - R)
+ *      Q = Q + S
+ *      S = r3 * (Q - S)
+ * Second layer: butterfly on (P, Q) and (R, S) for step = 2 * m
+ *      coef r1 = inv_W[start * n / (2 * m)]
+ *      P = P + Q
+ *      Q = r1 * (P - Q)
+ *      R = R + S
+ *      S = r1 * (R - S)
+ *
+ * @param buf - working buffers
+ * @param start - index of buffer among `m` ones
+ * @param m - group size of the second layer
+ */
+template <typename T>
+void Radix2<T>::butterfly_gs_two_layers_step(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m)
+{
+    butterfly_gs_two_layers_step_slow(buf, start, m);
+}
+
+template <typename T>
+void Radix2<T>::butterfly_gs_two_layers_step_slow(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    size_t offset)
+{
+    const unsigned step = m << 2;
+    //  ---------
+    // First layer
+    //  ---------
+    // first pair
+    const T r2 = inv_W->get(start * this->n / m / 4);
+    butterfly_gs_step_slow(buf, r2, start, 2 * m, step, offset);
+    // second pair
+    const T r3 = inv_W->get((start + m) * this->n / m / 4);
+    butterfly_gs_step_slow(buf, r3, start + m, 2 * m, step, offset);
+    //  ---------
+    // Second layer
+    //  ---------
+    const T r1 = inv_W->get(start * this->n / m / 2);
+    // first pair
+    butterfly_gs_step_slow(buf, r1, start, m, step, offset);
+    // second pair
+    butterfly_gs_step_slow(buf, r1, start + 2 * m, m, step, offset);
+}
+
 template <typename T>
 void Radix2<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
 {
@@ -753,6 +1043,11 @@ void Radix2<uint16_t>::butterfly_gs_step_simple(
     unsigned start,
     unsigned m,
     unsigned step);
+template <>
+void Radix2<uint16_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m);
 
 template <>
 void Radix2<uint32_t>::butterfly_ct_two_layers_step(
@@ -780,6 +1075,11 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     unsigned start,
     unsigned m,
     unsigned step);
+template <>
+void Radix2<uint32_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m);
 
 #endif // #ifdef QUADIRON_USE_SIMD
 
@@ -31,9 +31,12 @@
 #ifndef __QUAD_FFT_ADD_H__
 #define __QUAD_FFT_ADD_H__
 
+#include <algorithm>
+
 #include "arith.h"
 #include "fft_base.h"
 #include "gf_base.h"
+#include "vec_buffers.h"
 #include "vec_slice.h"
 #include "vec_vector.h"
 
@@ -45,6 +48,13 @@ namespace fft {
  * It works on length of 2<sup>m</sup> for arbitrary `m`.
  *
  * This is an implementation of the algorithm 2 in @cite fft-add.
+ *
+ * The Buffers versions process whole packets: additions and multiplications
+ * by constants are performed by the buffer operations of the field, that are
+ * vectorized for GF(2<sup>8</sup>) and GF(2<sup>16</sup>).
+ *
+ * @note As the Vector versions, they use scratch memory of the instance,
+ * hence an instance can't be used concurrently.
  */
 template <typename T>
 class Additive : public FourierTransform<T> {
@@ -65,20 +75,35 @@ class Additive : public FourierTransform<T> {
     void fft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void ifft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void fft_inv(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void fft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
     void taylor_expand_t2(vec::Vector<T>& input, int n);
     void
     taylor_expand(vec::Vector<T>& output, vec::Vector<T>& input, int n, int t);
+    void taylor_expand(
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& input,
+        int n,
+        int t);
     void inv_taylor_expand_t2(vec::Vector<T>& output);
     void
     inv_taylor_expand(vec::Vector<T>& output, vec::Vector<T>& input, int t);
+    void
+    inv_taylor_expand(vec::Buffers<T>& output, vec::Buffers<T>& input, int t);
 
   private:
     int find_k(int n, int t);
     void _taylor_expand_t2(vec::Vector<T>& input, int n, int k, int start);
     void _taylor_expand(vec::Vector<T>& input, int n, int t);
+    void _taylor_expand(T* const* bufs, size_t size, int n, int t);
+    void _inv_taylor_expand(T* const* bufs, size_t size, int n, int t);
     void mul_xt_x(vec::Vector<T>& vec, int t);
     void _fft(vec::Vector<T>& output, vec::Vector<T>& input);
     void _ifft(vec::Vector<T>& output, vec::Vector<T>& input);
+    void _fft(vec::Buffers<T>& output, vec::Buffers<T>& input);
+    void _ifft(vec::Buffers<T>& output, vec::Buffers<T>& input);
+    vec::Buffers<T>& get_bufs_mem(size_t size);
 
     bool create_betas;
     T m;
@@ -95,6 +120,8 @@ class Additive : public FourierTransform<T> {
     std::unique_ptr<vec::Vector<T>> u = nullptr;
     std::unique_ptr<vec::Vector<T>> v = nullptr;
     std::unique_ptr<vec::Vector<T>> mem = nullptr;
+    // Scratch of the Buffers versions, allocated for a given size of buffers
+    std::unique_ptr<vec::Buffers<T>> bufs_mem = nullptr;
     std::unique_ptr<Additive<T>> fft_add = nullptr;
 };
 
@@ -391,6 +418,169 @@ void Additive<T>::ifft(vec::Vector<T>& output, vec::Vector<T>& input)
     fft_inv(output, input);
 }
 
+/** Return `n` scratch buffers of `size` elements
+ *
+ * They are kept from a call to another as long as the size doesn't change.
+ */
+template <typename T>
+vec::Buffers<T>& Additive<T>::get_bufs_mem(size_t size)
+{
+    if (bufs_mem == nullptr || bufs_mem->get_size() != size) {
+        bufs_mem = std::make_unique<vec::Buffers<T>>(this->n, size);
+    }
+    return *bufs_mem;
+}
+
+template <typename T>
+void Additive<T>::_fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    const size_t size = input.get_size();
+    const int input_len = input.get_n();
+    vec::Buffers<T>& g = get_bufs_mem(size);
+    const std::vector<T*>& g_mem = g.get_mem();
+
+    // g(x) = f(beta_m * x), f being zero-extended to n coefficients
+    for (int i = 0; i < this->n; i++) {
+        if (i >= input_len) {
+            g.fill(i, 0);
+        } else if (beta_m > 1 && i > 0) {
+            this->gf->mul_coef_to_buf(
+                beta_m_powers->get(i), input.get(i), g_mem[i], size);
+        } else {
+            g.copy(i, input.get(i));
+        }
+    }
+
+    // compute taylor expansion of g(x) at (x^2 - x): g0 and g1 are the even
+    // and odd coefficients
+    _taylor_expand(g_mem.data(), size, this->n, 2);
+
+    std::vector<T*> g0_mem(m_k);
+    std::vector<T*> g1_mem(m_k);
+    for (T i = 0; i < m_k; i++) {
+        g0_mem[i] = g_mem[2 * i];
+        g1_mem[i] = g_mem[2 * i + 1];
+    }
+    vec::Buffers<T> g0(m_k, size, g0_mem);
+    vec::Buffers<T> g1(m_k, size, g1_mem);
+
+    // output = (u, v)
+    vec::Buffers<T> u(output, 0, m_k);
+    vec::Buffers<T> v(output, m_k, this->n);
+    this->fft_add->fft(u, g0);
+    this->fft_add->fft(v, g1);
+
+    // output = (u + G*v, (u + G*v) + v)
+    for (T i = 0; i < m_k; i++) {
+        const T coef = G->get(i);
+        if (coef != 0) {
+            this->gf->mul_coef_add_to_buf(coef, v.get(i), u.get(i), size);
+        }
+        this->gf->add_two_bufs(u.get(i), v.get(i), size);
+    }
+}
+
+template <typename T>
+void Additive<T>::_ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    const size_t size = input.get_size();
+    vec::Buffers<T>& w = get_bufs_mem(size);
+
+    /*
+     * input = (w0, w1)
+     * calculate u, v s.t. v = w1 - w0, u = w0 - G * v
+     */
+    vec::Buffers<T> u(w, 0, m_k);
+    vec::Buffers<T> v(w, m_k, this->n);
+    for (T i = 0; i < m_k; i++) {
+        T* w0 = input.get(i);
+        v.copy(i, input.get(m_k + i));
+        this->gf->add_two_bufs(w0, v.get(i), size);
+        u.copy(i, w0);
+        const T coef = G->get(i);
+        if (coef != 0) {
+            this->gf->mul_coef_add_to_buf(coef, v.get(i), u.get(i), size);
+        }
+    }
+
+    // g0 and g1 are the even and odd coefficients of the taylor expansion
+    const std::vector<T*>& output_mem = output.get_mem();
+    std::vector<T*> g0_mem(m_k);
+    std::vector<T*> g1_mem(m_k);
+    for (T i = 0; i < m_k; i++) {
+        g0_mem[i] = output_mem[2 * i];
+        g1_mem[i] = output_mem[2 * i + 1];
+    }
+    vec::Buffers<T> g0(m_k, size, g0_mem);
+    vec::Buffers<T> g1(m_k, size, g1_mem);
+    this->fft_add->fft_inv(g0, u);
+    this->fft_add->fft_inv(g1, v);
+
+    _inv_taylor_expand(output_mem.data(), size, this->n, 2);
+
+    // f(x) = g(beta_m^(-1) * x)
+    if (beta_m > 1) {
+        T coef = inv_beta_m;
+        for (int i = 1; i < this->n; i++) {
+            this->gf->mul_coef_to_buf(
+                coef, output_mem[i], output_mem[i], size);
+            coef = this->gf->mul(coef, inv_beta_m);
+        }
+    }
+}
+
+/** Compute the additive FFT of buffers.
+ *
+ * See the Vector version.
+ *
+ * @param output n buffers of the values
+ * @param input at most n buffers of the polynomial coefficients, the missing
+ * ones being zeros
+ */
+template <typename T>
+void Additive<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    assert(output.get_n() == this->n);
+    assert(input.get_n() <= this->n);
+
+    if (m > 1) {
+        _fft(output, input);
+        return;
+    }
+    // m == 1 -> output = (f(0), f(beta_1))
+    output.copy(0, input.get(0));
+    output.copy(1, input.get(0));
+    if (input.get_n() > 1) {
+        this->gf->mul_coef_add_to_buf(
+            this->beta_1, input.get(1), output.get(1), input.get_size());
+    }
+}
+
+template <typename T>
+void Additive<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    assert(output.get_n() == this->n);
+    assert(input.get_n() == this->n);
+
+    if (m > 1) {
+        _ifft(output, input);
+        return;
+    }
+    // m == 1 -> return ( input[0], (input[1] - input[0])*beta_1^-1 )
+    const size_t size = input.get_size();
+    output.copy(0, input.get(0));
+    output.copy(1, input.get(1));
+    this->gf->add_two_bufs(input.get(0), output.get(1), size);
+    this->gf->mul_coef_to_buf(
+        this->inv_beta_1, output.get(1), output.get(1), size);
+}
+
+template <typename T>
+void Additive<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv(output, input);
+}
+
 /**
  * Taylor expansion at (x^2 - x)
  *  Algorithm 1 in the paper of Shuhong Gao and Todd Mateer:
@@ -588,6 +778,84 @@ void Additive<T>::taylor_expand(
     }
 }
 
+/** Taylor expansion at (x^t - x) of buffers
+ *
+ * See the Vector version.
+ *
+ * @param output at least `n` buffers of the hi(x) polynomials
+ * @param input at most `n` buffers of the polynomial f(x)
+ * @param n n
+ * @param t t
+ */
+template <typename T>
+void Additive<T>::taylor_expand(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    int n,
+    int t)
+{
+    assert(n >= 1);
+    assert(t > 1);
+    assert(input.get_n() <= n);
+    assert(output.get_n() >= n);
+
+    const int input_len = input.get_n();
+    for (int i = 0; i < output.get_n(); i++) {
+        if (i < input_len) {
+            output.copy(i, input.get(i));
+        } else {
+            output.fill(i, 0);
+        }
+    }
+
+    if (n > t) {
+        _taylor_expand(output.get_mem().data(), output.get_size(), n, t);
+    }
+}
+
+/** Taylor expansion at (x^t - x) of the `n` buffers `bufs`, in place
+ *
+ * With \f$f = f_0 + x^{t2^k}(f_1 + x^{(t-1)2^k} f_2)\f$ and \f$h = f_1 +
+ * f_2\f$, it performs \f$g_0 = f_0 + x^{2^k} h\f$ and \f$g_1 = h + x^{(t-1)2^k}
+ * f_2\f$ then expands both, as \f$f = g_0 + (x^t - x)^{2^k} g_1\f$.
+ *
+ * @param bufs buffers of the coefficients
+ * @param size size of the buffers
+ * @param n number of coefficients
+ * @param t t
+ */
+template <typename T>
+void Additive<T>::_taylor_expand(T* const* bufs, size_t size, int n, int t)
+{
+    // find k s.t. t2^k < n <= 2 *t2^k
+    const int k = find_k(n, t);
+    const int deg2 = arith::exp2<T>(k);
+    const int deg0 = t * deg2;
+    const int deg1 = deg0 - deg2;
+    const int g1deg = n - deg0;
+    const int hdeg = std::min(deg1, g1deg);
+    // f2 may be shorter than 2^k
+    const int f2deg = std::max(0, g1deg - deg1);
+
+    T* const* g0 = bufs;
+    T* const* g1 = bufs + deg0;
+    T* const* f2 = g1 + deg1;
+
+    // h = f1 + f2 is stored in place of f1, so that g1 is in place too
+    for (int i = 0; i < f2deg; i++) {
+        this->gf->add_two_bufs(f2[i], g1[i], size);
+    }
+    // add h into g0 with offset deg2=2^k
+    for (int i = 0; i < hdeg; i++) {
+        this->gf->add_two_bufs(g1[i], g0[deg2 + i], size);
+    }
+
+    if (deg0 > t)
+        _taylor_expand(g0, size, deg0, t);
+    if (g1deg > t)
+        _taylor_expand(g1, size, g1deg, t);
+}
+
 template <typename T>
 void Additive<T>::_taylor_expand(vec::Vector<T>& input, int n, int t)
 {
@@ -664,6 +932,73 @@ void Additive<T>::inv_taylor_expand(
     output.copy(&tmp, o_len);
 }
 
+/** Compute f(x) from its taylor expansion at (x^t - x), for buffers
+ *
+ * Contrary to the Vector version, it undoes the steps of the expansion, as
+ * additions are involutions in characteristic 2.
+ *
+ * @param output buffers of the first coefficients of f(x)
+ * @param input buffers of the hi(x) polynomials
+ * @param t t
+ */
+template <typename T>
+void Additive<T>::inv_taylor_expand(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    int t)
+{
+    const int i_len = input.get_n();
+    const int o_len = output.get_n();
+    const size_t size = input.get_size();
+
+    assert(o_len <= this->n);
+    assert(i_len >= o_len);
+
+    // the expansion is undone in the output buffers, extended by temporary
+    // ones for the coefficients that are not returned
+    vec::Buffers<T> extra(std::max(i_len - o_len, 1), size);
+    std::vector<T*> tmp(output.get_mem());
+    for (int i = o_len; i < i_len; i++) {
+        tmp.push_back(extra.get(i - o_len));
+    }
+    for (int i = 0; i < i_len; i++) {
+        std::copy_n(input.get(i), size, tmp[i]);
+    }
+
+    if (i_len > t) {
+        _inv_taylor_expand(tmp.data(), size, i_len, t);
+    }
+}
+
+/** Inverse of the in place taylor expansion of `_taylor_expand` */
+template <typename T>
+void Additive<T>::_inv_taylor_expand(T* const* bufs, size_t size, int n, int t)
+{
+    const int k = find_k(n, t);
+    const int deg2 = arith::exp2<T>(k);
+    const int deg0 = t * deg2;
+    const int deg1 = deg0 - deg2;
+    const int g1deg = n - deg0;
+    const int hdeg = std::min(deg1, g1deg);
+    const int f2deg = std::max(0, g1deg - deg1);
+
+    T* const* g0 = bufs;
+    T* const* g1 = bufs + deg0;
+    T* const* f2 = g1 + deg1;
+
+    if (deg0 > t)
+        _inv_taylor_expand(g0, size, deg0, t);
+    if (g1deg > t)
+        _inv_taylor_expand(g1, size, g1deg, t);
+
+    for (int i = 0; i < hdeg; i++) {
+        this->gf->add_two_bufs(g1[i], g0[deg2 + i], size);
+    }
+    for (int i = 0; i < f2deg; i++) {
+        this->gf->add_two_bufs(f2[i], g1[i], size);
+    }
+}
+
 } // namespace fft
 } // namespace quadiron
 
@@ -36,6 +36,8 @@
 #include "fft_base.h"
 #include "fft_naive.h"
 #include "gf_base.h"
+#include "thread_pool.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 #include "vec_view.h"
 
@@ -81,6 +83,10 @@ namespace fft {
  * - Step1: calculate the inner DFT, i.e. \f$\sum_{i_2}\f$
  * - Step2: multiply to twiddle factors \f$w^{i_1 k_2}\f$
  * - Step3: calculate outer DFT, i.e. \f$\sum_{i_1}\f$
+ *
+ * The Buffers versions work on packets of `pkt_size` elements. Their `n_1`
+ * inner DFTs, then their `n_2` outer DFTs, are independent and run on the
+ * thread pool given by `set_thread_pool`, if any.
  */
 template <typename T>
 class CooleyTukey : public FourierTransform<T> {
@@ -94,14 +100,30 @@ class CooleyTukey : public FourierTransform<T> {
         T n,
         int id = 0,
         std::vector<T>* factors = nullptr,
-        T _w = 0);
+        T _w = 0,
+        size_t pkt_size = 0);
     ~CooleyTukey();
     void fft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void ifft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void fft_inv(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void fft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+
+    /** Run the sub-transforms of the Buffers versions on `pool`
+     *
+     * @note The pool must not be the one running the caller, as the batches
+     * of a pool are serialized. Nullptr runs them sequentially.
+     */
+    void set_thread_pool(ThreadPool* pool)
+    {
+        this->pool = pool;
+    }
 
   private:
     void _fft(vec::Vector<T>& output, vec::Vector<T>& input, bool inv);
+    void _fft(vec::Buffers<T>& output, vec::Buffers<T>& input, bool inv);
+    void run_tasks(size_t n_tasks, const std::function<void(size_t)>& task);
 
     bool loop;
     bool first_layer_fft;
@@ -114,6 +136,8 @@ class CooleyTukey : public FourierTransform<T> {
     FourierTransform<T>* dft_outer = nullptr;
     FourierTransform<T>* dft_inner = nullptr;
     std::vector<T> prime_factors;
+    size_t pkt_size;
+    ThreadPool* pool = nullptr;
     void mul_twiddle_factors(bool inv);
 };
 
@@ -122,6 +146,7 @@ class CooleyTukey : public FourierTransform<T> {
  * n-th root will be constructed with primitive root
  *
  * @param id index in the list of factors of n
+ * @param pkt_size size of the buffers of the Buffers versions
  */
 template <typename T>
 CooleyTukey<T>::CooleyTukey(
@@ -129,9 +154,11 @@ CooleyTukey<T>::CooleyTukey(
     T n,
     int id,
     std::vector<T>* factors,
-    T _w)
+    T _w,
+    size_t pkt_size)
     : FourierTransform<T>(gf, n)
 {
+    this->pkt_size = pkt_size;
     if (factors == nullptr) {
         first_layer_fft = true;
         this->prime_factors = arith::get_prime_factors<T>(n);
@@ -150,7 +177,7 @@ CooleyTukey<T>::CooleyTukey(
     if (n1 == 2) {
         this->dft_outer = new fft::Size2<T>(gf);
     } else {
-        this->dft_outer = new fft::Naive<T>(gf, n1, w1);
+        this->dft_outer = new fft::Naive<T>(gf, n1, w1, pkt_size);
     }
 
     if (n2 > 1) {
@@ -161,8 +188,8 @@ CooleyTukey<T>::CooleyTukey(
         // if (_is_power_of_2<T>(_n2))
         //   this->dft_inner = new fft::Radix2<T>(gf, _n2);
         // else
-        this->dft_inner =
-            new CooleyTukey<T>(gf, _n2, id + 1, &this->prime_factors, w2);
+        this->dft_inner = new CooleyTukey<T>(
+            gf, _n2, id + 1, &this->prime_factors, w2, pkt_size);
         this->G = new vec::Vector<T>(gf, this->n);
         this->Y = new vec::View<T>(this->G);
         this->X = new vec::View<T>(this->G);
@@ -246,6 +273,108 @@ void CooleyTukey<T>::_fft(
     }
 }
 
+template <typename T>
+void CooleyTukey<T>::run_tasks(
+    size_t n_tasks,
+    const std::function<void(size_t)>& task)
+{
+    if (pool) {
+        pool->run(n_tasks, task);
+    } else {
+        for (size_t i = 0; i < n_tasks; i++) {
+            task(i);
+        }
+    }
+}
+
+/** FFT of buffers
+ *
+ * The buffers of the sub-transforms are picked among the ones of `input`,
+ * `output` and a temporary `G`, hence no data is moved but by the DFTs. `G`
+ * is allocated by each call so that the sub-transforms can run concurrently.
+ */
+template <typename T>
+void CooleyTukey<T>::_fft(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    bool inv)
+{
+    vec::Buffers<T> G(this->n, pkt_size);
+    const std::vector<T*>& g_mem = G.get_mem();
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+    const T _w = inv ? inv_w : w;
+
+    run_tasks(n1, [&](size_t i1) {
+        std::vector<T*> x_mem(n2);
+        std::vector<T*> y_mem(n2);
+        for (T i2 = 0; i2 < n2; i2++) {
+            x_mem[i2] = i_mem[i1 + n1 * i2];
+            y_mem[i2] = g_mem[i1 + n1 * i2];
+        }
+        vec::Buffers<T> X(n2, pkt_size, x_mem);
+        vec::Buffers<T> Y(n2, pkt_size, y_mem);
+        if (inv)
+            this->dft_inner->fft_inv(Y, X);
+        else
+            this->dft_inner->fft(Y, X);
+
+        // multiply to twiddle factors w^(i1 * k2)
+        if (i1 > 0) {
+            const T base = this->gf->exp(_w, i1);
+            T factor = base;
+            for (T k2 = 1; k2 < n2; k2++) {
+                this->gf->mul_coef_to_buf(
+                    factor, y_mem[k2], y_mem[k2], pkt_size);
+                factor = this->gf->mul(factor, base);
+            }
+        }
+    });
+
+    run_tasks(n2, [&](size_t k2) {
+        std::vector<T*> x_mem(n1);
+        std::vector<T*> y_mem(n1);
+        for (T k1 = 0; k1 < n1; k1++) {
+            x_mem[k1] = o_mem[k2 + n2 * k1];
+            y_mem[k1] = g_mem[k2 * n1 + k1];
+        }
+        vec::Buffers<T> X(n1, pkt_size, x_mem);
+        vec::Buffers<T> Y(n1, pkt_size, y_mem);
+        if (inv)
+            this->dft_outer->fft_inv(X, Y);
+        else
+            this->dft_outer->fft(X, Y);
+    });
+}
+
+template <typename T>
+void CooleyTukey<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    if (!loop)
+        dft_outer->fft(output, input);
+    else
+        _fft(output, input, false);
+}
+
+template <typename T>
+void CooleyTukey<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    if (!loop)
+        dft_outer->fft_inv(output, input);
+    else
+        _fft(output, input, true);
+}
+
+template <typename T>
+void CooleyTukey<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv(output, input);
+
+    if (this->first_layer_fft && (this->inv_n_mod_p > 1)) {
+        this->gf->mul_vec_to_vecp(*(this->vec_inv_n), output, output);
+    }
+}
+
 template <typename T>
 void CooleyTukey<T>::fft(vec::Vector<T>& output, vec::Vector<T>& input)
 {
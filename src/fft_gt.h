@@ -38,6 +38,8 @@
 #include "fft_ct.h"
 #include "fft_naive.h"
 #include "gf_base.h"
+#include "thread_pool.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 #include "vec_view.h"
 
@@ -93,6 +95,9 @@ namespace fft {
  * - Step1: calculate DFT of the inner parenthese, i.e. \f$\sum_{i_2}\f$
  * - Step2: calculate DFT of the outer parenthese, i.e. \f$\sum_{i_1}\f$
  *
+ * As for fft::CooleyTukey, the DFTs of each step of the Buffers versions can
+ * run on a thread pool.
+ *
  * @see <a href="https://en.wikipedia.org/wiki/Prime-factor_FFT_algorithm">
  * Prime-factor FFT algorithm
  * </a>
@@ -109,14 +114,29 @@ class GoodThomas : public FourierTransform<T> {
         T n,
         int id = 0,
         std::vector<T>* factors = nullptr,
-        T _w = 0);
+        T _w = 0,
+        size_t pkt_size = 0);
     ~GoodThomas();
     void fft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void ifft(vec::Vector<T>& output, vec::Vector<T>& input) override;
     void fft_inv(vec::Vector<T>& output, vec::Vector<T>& input) override;
+    void fft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void ifft(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+    void fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input) override;
+
+    /** Run the sub-transforms of the Buffers versions on `pool`
+     *
+     * @see CooleyTukey::set_thread_pool
+     */
+    void set_thread_pool(ThreadPool* pool)
+    {
+        this->pool = pool;
+    }
 
   private:
     void _fft(vec::Vector<T>& output, vec::Vector<T>& input, bool inv);
+    void _fft(vec::Buffers<T>& output, vec::Buffers<T>& input, bool inv);
+    void run_tasks(size_t n_tasks, const std::function<void(size_t)>& task);
     T _inverse_mod(T nb, T mod);
 
     bool loop;
@@ -131,12 +151,15 @@ class GoodThomas : public FourierTransform<T> {
     FourierTransform<T>* dft_outer = nullptr;
     FourierTransform<T>* dft_inner = nullptr;
     std::vector<T> prime_factors;
+    size_t pkt_size;
+    ThreadPool* pool = nullptr;
 };
 
 /**
  * n-th root will be constructed with primitive root
  *
  * @param id index in the list of factors of n
+ * @param pkt_size size of the buffers of the Buffers versions
  */
 template <typename T>
 GoodThomas<T>::GoodThomas(
@@ -144,9 +167,11 @@ GoodThomas<T>::GoodThomas(
     T n,
     int id,
     std::vector<T>* factors,
-    T _w)
+    T _w,
+    size_t pkt_size)
     : FourierTransform<T>(gf, n)
 {
+    this->pkt_size = pkt_size;
     if (factors == nullptr) {
         first_layer_fft = true;
         this->prime_factors = arith::get_coprime_factors<T>(n);
@@ -169,7 +194,7 @@ GoodThomas<T>::GoodThomas(
     if (n1 == 2) {
         this->dft_outer = new fft::Size2<T>(gf);
     } else {
-        this->dft_outer = new fft::Naive<T>(gf, n1, w1);
+        this->dft_outer = new fft::Naive<T>(gf, n1, w1, pkt_size);
     }
 
     if (n2 > 1) {
@@ -177,10 +202,10 @@ GoodThomas<T>::GoodThomas(
         w2 = gf.exp(w, n1); // order of w2 = n2
         T _n2 = n / n1;
         if (arith::is_power_of_2<T>(_n2)) {
-            this->dft_inner = new fft::Radix2<T>(gf, _n2);
+            this->dft_inner = new fft::Radix2<T>(gf, _n2, _n2, pkt_size);
         } else {
             this->dft_inner = new fft::CooleyTukey<T>(
-                gf, _n2, id + 1, &this->prime_factors, w2);
+                gf, _n2, id + 1, &this->prime_factors, w2, pkt_size);
         }
         this->G = new vec::Vector<T>(gf, this->n);
         this->Y = new vec::View<T>(this->G);
@@ -253,6 +278,95 @@ void GoodThomas<T>::_fft(
     }
 }
 
+template <typename T>
+void GoodThomas<T>::run_tasks(
+    size_t n_tasks,
+    const std::function<void(size_t)>& task)
+{
+    if (pool) {
+        pool->run(n_tasks, task);
+    } else {
+        for (size_t i = 0; i < n_tasks; i++) {
+            task(i);
+        }
+    }
+}
+
+/** FFT of buffers
+ *
+ * The index mappings pick buffers of `input`, `output` and a temporary `G`
+ * allocated by each call, so that the sub-transforms can run concurrently.
+ */
+template <typename T>
+void GoodThomas<T>::_fft(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    bool inv)
+{
+    vec::Buffers<T> G(this->n, pkt_size);
+    const std::vector<T*>& g_mem = G.get_mem();
+    const std::vector<T*>& i_mem = input.get_mem();
+    const std::vector<T*>& o_mem = output.get_mem();
+
+    run_tasks(n1, [&](size_t i1) {
+        std::vector<T*> x_mem(n2);
+        std::vector<T*> y_mem(n2);
+        for (T i2 = 0; i2 < n2; i2++) {
+            x_mem[i2] = i_mem[(a * i1 + b * i2) % this->n];
+            y_mem[i2] = g_mem[i1 + n1 * i2];
+        }
+        vec::Buffers<T> X(n2, pkt_size, x_mem);
+        vec::Buffers<T> Y(n2, pkt_size, y_mem);
+        if (inv)
+            this->dft_inner->fft_inv(Y, X);
+        else
+            this->dft_inner->fft(Y, X);
+    });
+
+    run_tasks(n2, [&](size_t k2) {
+        std::vector<T*> x_mem(n1);
+        std::vector<T*> y_mem(n1);
+        for (T k1 = 0; k1 < n1; k1++) {
+            x_mem[k1] = o_mem[(d * k2 + c * k1) % this->n];
+            y_mem[k1] = g_mem[k2 * n1 + k1];
+        }
+        vec::Buffers<T> X(n1, pkt_size, x_mem);
+        vec::Buffers<T> Y(n1, pkt_size, y_mem);
+        if (inv)
+            this->dft_outer->fft_inv(X, Y);
+        else
+            this->dft_outer->fft(X, Y);
+    });
+}
+
+template <typename T>
+void GoodThomas<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    if (!loop)
+        dft_outer->fft(output, input);
+    else
+        _fft(output, input, false);
+}
+
+template <typename T>
+void GoodThomas<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    if (!loop)
+        dft_outer->fft_inv(output, input);
+    else
+        _fft(output, input, true);
+}
+
+template <typename T>
+void GoodThomas<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
+{
+    fft_inv(output, input);
+
+    if (this->first_layer_fft && (this->inv_n_mod_p > 1)) {
+        this->gf->mul_vec_to_vecp(*(this->vec_inv_n), output, output);
+    }
+}
+
 template <typename T>
 void GoodThomas<T>::fft(vec::Vector<T>& output, vec::Vector<T>& input)
 {
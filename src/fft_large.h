@@ -34,6 +34,7 @@
 #include "arith.h"
 #include "fft_base.h"
 #include "gf_base.h"
+#include "vec_buffers.h"
 #include "vec_matrix.h"
 #include "vec_vector.h"
 
@@ -58,6 +59,8 @@ class Large : public FourierTransform<T> {
   private:
     void
     _fft(vec::Vector<T>& output, vec::Vector<T>& input, vec::Vector<T>& _W);
+    void
+    _fft(vec::Buffers<T>& output, vec::Buffers<T>& input, vec::Vector<T>& _W);
 
     int l;
     T w;
@@ -241,22 +244,64 @@ void Large<T>::ifft(vec::Vector<T>& output, vec::Vector<T>& input)
         output.mul_scalar(this->inv_n_mod_p);
 }
 
+/** Compute the FFT of buffers
+ *
+ * It performs the same steps as the Vector version on whole buffers. Only
+ * two consecutive rows of `phi` are kept, and the last one is directly stored
+ * into `output`.
+ */
+template <typename T>
+void Large<T>::_fft(
+    vec::Buffers<T>& output,
+    vec::Buffers<T>& input,
+    vec::Vector<T>& _W)
+{
+    const size_t size = input.get_size();
+
+    // rows i - 1 and i of phi, phi[0] being the input
+    std::unique_ptr<vec::Buffers<T>> rows[2];
+    if (this->l > 1) {
+        rows[0] = std::make_unique<vec::Buffers<T>>(this->n, size);
+        rows[1] = std::make_unique<vec::Buffers<T>>(this->n, size);
+    }
+    vec::Buffers<T>* prev = &input;
+
+    for (int i = 1; i <= this->l; i++) {
+        vec::Buffers<T>* cur = rows[i % 2].get();
+        for (int j = 0; j <= this->n - 1; j++) {
+            // the FFT is the last row where `phi[l][tmp5[j]]` is output `j`
+            T* dest = (i == this->l) ? output.get(j) : cur->get(j);
+            const int k = (i == this->l) ? tmp5->get(j) : j;
+
+            this->gf->mul_coef_to_buf(
+                _W.get(tmp4->get(i, k)),
+                prev->get(tmp3->get(i, k)),
+                dest,
+                size);
+            this->gf->add_two_bufs(prev->get(tmp2->get(i, k)), dest, size);
+        }
+        prev = cur;
+    }
+}
+
 template <typename T>
-void Large<T>::fft(vec::Buffers<T>&, vec::Buffers<T>&)
+void Large<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
 {
-    // TBD
+    _fft(output, input, *W);
 }
 
 template <typename T>
-void Large<T>::ifft(vec::Buffers<T>&, vec::Buffers<T>&)
+void Large<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
 {
-    // TBD
+    _fft(output, input, *inv_W);
 }
 
 template <typename T>
-void Large<T>::fft_inv(vec::Buffers<T>&, vec::Buffers<T>&)
+void Large<T>::ifft(vec::Buffers<T>& output, vec::Buffers<T>& input)
 {
-    // TBD
+    fft_inv(output, input);
+    if (this->inv_n_mod_p > 1)
+        this->gf->mul_vec_to_vecp(*(this->vec_inv_n), output, output);
 }
 
 } // namespace fft
@@ -35,6 +35,7 @@
 
 #include "exceptions.h"
 #include "gf_base.h"
+#include "simd_dispatch.h"
 
 namespace quadiron {
 namespace gf {
@@ -56,6 +57,11 @@ class BinExtension : public gf::Field<T> {
     T exp(T a, T b) const override;
     T log(T a, T b) const override;
     void hadamard_mul(int n, T* x, T* y) const override;
+    void mul_coef_to_buf(T a, T* src, T* dest, size_t len) const override;
+    void
+    mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const override;
+    void add_two_bufs(T* src, T* dest, size_t len) const override;
+    void sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const override;
 
     BinExtension(BinExtension&&) = default;
 
@@ -80,6 +86,7 @@ class BinExtension : public gf::Field<T> {
     T _div_by_inv(T a, T b) const;
     T _inv_by_div(T a) const;
     T _inv_ext_gcd(T a) const;
+    void setup_coef_tables(T a, uint8_t* tables) const;
     int mul_type;
     int div_type;
     int inv_type;
@@ -590,6 +597,77 @@ inline void BinExtension<T>::hadamard_mul(int n, T* x, T* y) const
     }
 }
 
+/**
+ * Setup the 4-bit split tables used by the SIMD multiplication by `a`
+ *
+ * There are (n/4) * (n/8) tables of 16 bytes: the table `i * (n/8) + b` holds
+ * the byte `b` of `a * (v << 4i)` for v = 0, .., 15 (see `simd_gf2n.h`).
+ */
+template <typename T>
+void BinExtension<T>::setup_coef_tables(T a, uint8_t* tables) const
+{
+    const unsigned bytes_nb = n / 8;
+    for (unsigned i = 0; i < n / 4; i++) {
+        for (unsigned v = 0; v < 16; v++) {
+            const T product = mul(a, T(v) << (4 * i));
+            for (unsigned b = 0; b < bytes_nb; b++) {
+                tables[(i * bytes_nb + b) * 16 + v] =
+                    static_cast<uint8_t>(product >> (8 * b));
+            }
+        }
+    }
+}
+
+template <typename T>
+void BinExtension<T>::mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    const simd::Gf2nKernels<T>* kernels = simd::get_gf2n_kernels<T>();
+    if (kernels == nullptr || (n != 8 && n != 16)) {
+        this->mul_coef_to_buf_slow(a, src, dest, len);
+        return;
+    }
+    // at most 4 nibbles of 2 bytes in GF(2^16)
+    uint8_t tables[4 * 2 * 16];
+    setup_coef_tables(a, tables);
+    kernels->mul_coef_to_buf(tables, n, src, dest, len);
+}
+
+template <typename T>
+void BinExtension<T>::mul_coef_add_to_buf(T a, T* src, T* dest, size_t len)
+    const
+{
+    const simd::Gf2nKernels<T>* kernels = simd::get_gf2n_kernels<T>();
+    if (kernels == nullptr || (n != 8 && n != 16)) {
+        gf::Field<T>::mul_coef_add_to_buf(a, src, dest, len);
+        return;
+    }
+    uint8_t tables[4 * 2 * 16];
+    setup_coef_tables(a, tables);
+    kernels->mul_coef_add_to_buf(tables, n, src, dest, len);
+}
+
+template <typename T>
+void BinExtension<T>::add_two_bufs(T* src, T* dest, size_t len) const
+{
+    const simd::Gf2nKernels<T>* kernels = simd::get_gf2n_kernels<T>();
+    if (kernels == nullptr) {
+        this->add_two_bufs_slow(src, dest, len);
+        return;
+    }
+    kernels->add_two_bufs(src, dest, dest, len);
+}
+
+template <typename T>
+void BinExtension<T>::sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const
+{
+    const simd::Gf2nKernels<T>* kernels = simd::get_gf2n_kernels<T>();
+    if (kernels == nullptr) {
+        this->sub_two_bufs_slow(bufa, bufb, res, len);
+        return;
+    }
+    kernels->add_two_bufs(bufa, bufb, res, len);
+}
+
 } // namespace gf
 } // namespace quadiron
 
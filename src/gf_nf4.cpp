@@ -32,7 +32,7 @@
 
 #ifdef QUADIRON_USE_SIMD
 
-#include "simd.h"
+#include "simd_dispatch.h"
 
 namespace quadiron {
 namespace gf {
@@ -40,63 +40,104 @@ namespace gf {
 template <>
 __uint128_t NF4<__uint128_t>::expand16(uint16_t* arr) const
 {
-    return simd::expand16(arr, this->n);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return expand16_slow(arr);
+    }
+    return kernels->expand16(arr, this->n);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::expand32(uint32_t* arr) const
 {
-    return simd::expand32(arr, this->n);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return expand32_slow(arr);
+    }
+    return kernels->expand32(arr, this->n);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::add(__uint128_t a, __uint128_t b) const
 {
-    __uint128_t c = simd::add(a, b);
-    return c;
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return add_slow(a, b);
+    }
+    return kernels->add(a, b);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::sub(__uint128_t a, __uint128_t b) const
 {
-    return simd::sub(a, b);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return sub_slow(a, b);
+    }
+    return kernels->sub(a, b);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::mul(__uint128_t a, __uint128_t b) const
 {
-    return simd::mul(a, b);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return mul_slow(a, b);
+    }
+    return kernels->mul(a, b);
 }
 
 template <>
 void NF4<__uint128_t>::hadamard_mul(int n, __uint128_t* x, __uint128_t* y) const
 {
-    simd::hadamard_mul(n, x, y);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        hadamard_mul_slow(n, x, y);
+        return;
+    }
+    kernels->hadamard_mul(n, x, y);
 }
 
 template <>
 GroupedValues<__uint128_t> NF4<__uint128_t>::unpack(__uint128_t a) const
 {
-    return simd::unpack(a);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return unpack_slow(a);
+    }
+    return kernels->unpack(a);
 }
 
 template <>
 void NF4<__uint128_t>::unpack(__uint128_t a, GroupedValues<__uint128_t>& b)
     const
 {
-    simd::unpack(a, b);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        unpack_slow(a, b);
+        return;
+    }
+    kernels->unpack_to(a, b);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::pack(__uint128_t a) const
 {
-    return simd::pack(a);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return pack_slow(a);
+    }
+    return kernels->pack(a);
 }
 
 template <>
 __uint128_t NF4<__uint128_t>::pack(__uint128_t a, uint32_t flag) const
 {
-    return simd::pack(a, flag);
+    const simd::Nf4Kernels* kernels = simd::get_nf4_kernels();
+    if (kernels == nullptr) {
+        return pack_slow(a, flag);
+    }
+    return kernels->pack_flagged(a, flag);
 }
 
 } // namespace gf
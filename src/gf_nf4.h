@@ -31,6 +31,7 @@
 #ifndef __QUAD_GF_NF4_H__
 #define __QUAD_GF_NF4_H__
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -81,6 +82,8 @@ class NF4 : public gf::Field<T> {
     T pack(T a, uint32_t flag) const;
     GroupedValues<T> unpack(T a) const;
     void unpack(T a, GroupedValues<T>& b) const;
+    void split_lanes(const T* src, uint32_t* const* lanes, size_t len) const;
+    void merge_lanes(const uint32_t* const* lanes, T* dest, size_t len) const;
     T get_nth_root(T n) const override;
     void compute_omegas(vec::Vector<T>& W, int n, T w) const override;
     const gf::Field<uint32_t>& get_sub_field() const;
@@ -108,6 +111,19 @@ class NF4 : public gf::Field<T> {
 
     T expand16(uint16_t* arr) const;
     T expand32(uint32_t* arr) const;
+
+    // Scalar implementations, also used when no SIMD kernel is available.
+    T expand16_slow(uint16_t* arr) const;
+    T expand32_slow(uint32_t* arr) const;
+    T add_slow(T a, T b) const;
+    T sub_slow(T a, T b) const;
+    T mul_slow(T a, T b) const;
+    T pack_slow(T a) const;
+    T pack_slow(T a, uint32_t flag) const;
+    GroupedValues<T> unpack_slow(T a) const;
+    void unpack_slow(T a, GroupedValues<T>& b) const;
+    void hadamard_mul_slow(int n, T* x, T* y) const;
+
     // to debug
     void show_arr(uint32_t* arr);
 };
@@ -149,6 +165,12 @@ bool NF4<T>::check_n(unsigned n)
 
 template <typename T>
 inline T NF4<T>::expand16(uint16_t* arr) const
+{
+    return expand16_slow(arr);
+}
+
+template <typename T>
+inline T NF4<T>::expand16_slow(uint16_t* arr) const
 {
     T c = arr[this->n - 1];
     for (int i = this->n - 2; i >= 0; i--) {
@@ -159,6 +181,12 @@ inline T NF4<T>::expand16(uint16_t* arr) const
 
 template <typename T>
 inline T NF4<T>::expand32(uint32_t* arr) const
+{
+    return expand32_slow(arr);
+}
+
+template <typename T>
+inline T NF4<T>::expand32_slow(uint32_t* arr) const
 {
     T c = arr[this->n - 1];
     for (int i = this->n - 2; i >= 0; i--) {
@@ -213,6 +241,12 @@ inline T NF4<T>::neg(T a) const
 
 template <typename T>
 inline T NF4<T>::add(T a, T b) const
+{
+    return add_slow(a, b);
+}
+
+template <typename T>
+inline T NF4<T>::add_slow(T a, T b) const
 {
     scratch32[0] =
         (narrow_cast<uint32_t>(a) + narrow_cast<uint32_t>(b)) % 65537;
@@ -230,6 +264,12 @@ inline T NF4<T>::add(T a, T b) const
 
 template <typename T>
 inline T NF4<T>::sub(T a, T b) const
+{
+    return sub_slow(a, b);
+}
+
+template <typename T>
+inline T NF4<T>::sub_slow(T a, T b) const
 {
     uint32_t ae, be;
 
@@ -251,6 +291,12 @@ inline T NF4<T>::sub(T a, T b) const
 
 template <typename T>
 inline T NF4<T>::mul(T a, T b) const
+{
+    return mul_slow(a, b);
+}
+
+template <typename T>
+inline T NF4<T>::mul_slow(T a, T b) const
 {
     uint64_t ae;
     uint32_t be;
@@ -353,6 +399,12 @@ T NF4<T>::unpacked_rand(void) const
  */
 template <typename T>
 inline T NF4<T>::pack(T a) const
+{
+    return pack_slow(a);
+}
+
+template <typename T>
+inline T NF4<T>::pack_slow(T a) const
 {
     scratch32[0] = static_cast<uint32_t>(a & MASK16);
     for (int i = 1; i < this->n; i++) {
@@ -370,6 +422,12 @@ inline T NF4<T>::pack(T a) const
  */
 template <typename T>
 inline T NF4<T>::pack(T a, uint32_t flag) const
+{
+    return pack_slow(a, flag);
+}
+
+template <typename T>
+inline T NF4<T>::pack_slow(T a, uint32_t flag) const
 {
     scratch32[0] = (flag & 1) ? 65536 : static_cast<uint32_t>(a & MASK16);
     for (int i = 1; i < this->n; i++) {
@@ -389,6 +447,12 @@ inline T NF4<T>::pack(T a, uint32_t flag) const
  */
 template <typename T>
 inline GroupedValues<T> NF4<T>::unpack(T a) const
+{
+    return unpack_slow(a);
+}
+
+template <typename T>
+inline GroupedValues<T> NF4<T>::unpack_slow(T a) const
 {
     GroupedValues<T> b = GroupedValues<T>();
     uint32_t flag = 0;
@@ -419,6 +483,12 @@ inline GroupedValues<T> NF4<T>::unpack(T a) const
 
 template <typename T>
 inline void NF4<T>::unpack(T a, GroupedValues<T>& b) const
+{
+    unpack_slow(a, b);
+}
+
+template <typename T>
+inline void NF4<T>::unpack_slow(T a, GroupedValues<T>& b) const
 {
     uint32_t flag = 0;
     uint32_t ae;
@@ -445,6 +515,52 @@ inline void NF4<T>::unpack(T a, GroupedValues<T>& b) const
     b.values = expand16(scratch16.data());
 }
 
+/** Split unpacked elements into the planar layout
+ *
+ * In the planar layout, the `i`-th values of the elements are stored
+ * contiguously in `lanes[i]`, one 32-bit word per value, so that each lane
+ * is processed as a buffer of GF(F<sub>4</sub>) without packing.
+ *
+ * @param src `len` unpacked elements, i.e. of `n` 16-bit values
+ * @param lanes `n` lanes of `len` values
+ * @param len number of elements
+ */
+template <typename T>
+void NF4<T>::split_lanes(const T* src, uint32_t* const* lanes, size_t len)
+    const
+{
+    for (int i = 0; i < this->n; i++) {
+        uint32_t* lane = lanes[i];
+        const unsigned shift = 16 * i;
+        for (size_t j = 0; j < len; j++) {
+            lane[j] = static_cast<uint32_t>((src[j] >> shift) & MASK16);
+        }
+    }
+}
+
+/** Merge planar lanes into unpacked elements
+ *
+ * A value equal to 65536 is considered as zero, as by `unpack`: it must be
+ * marked by the caller.
+ *
+ * @param lanes `n` lanes of `len` values
+ * @param dest `len` unpacked elements
+ * @param len number of elements
+ */
+template <typename T>
+void NF4<T>::merge_lanes(const uint32_t* const* lanes, T* dest, size_t len)
+    const
+{
+    std::fill_n(dest, len, 0);
+    for (int i = 0; i < this->n; i++) {
+        const uint32_t* lane = lanes[i];
+        const unsigned shift = 16 * i;
+        for (size_t j = 0; j < len; j++) {
+            dest[j] |= static_cast<T>(lane[j] & MASK16) << shift;
+        }
+    }
+}
+
 // Use for fft
 template <typename T>
 inline T NF4<T>::get_nth_root(T n) const
@@ -482,6 +598,12 @@ const gf::Field<uint32_t>& NF4<T>::get_sub_field() const
 
 template <typename T>
 inline void NF4<T>::hadamard_mul(int n, T* x, T* y) const
+{
+    hadamard_mul_slow(n, x, y);
+}
+
+template <typename T>
+inline void NF4<T>::hadamard_mul_slow(int n, T* x, T* y) const
 {
     for (int i = 0; i < n; i++) {
         x[i] = mul(x[i], y[i]);
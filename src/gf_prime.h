@@ -56,6 +56,7 @@ class Prime : public gf::Field<T> {
 template <typename T>
 Prime<T>::Prime(T p) : gf::Field<T>(p, 1)
 {
+    this->shoup_mul = arith::is_shoup_modulus<T>(p);
 }
 
 /// Inverse by exponentiation.
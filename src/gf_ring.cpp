@@ -31,90 +31,154 @@
 #include "gf_ring.h"
 
 #ifdef QUADIRON_USE_SIMD
-#include "simd.h"
-#include "simd/simd.h"
+#include "simd_dispatch.h"
 
 namespace quadiron {
 namespace gf {
 
-template <>
-void RingModN<uint16_t>::neg(size_t n, uint16_t* x) const
+namespace {
+
+/** Return the SIMD kernels if they apply to the ring of cardinal `card`
+ *
+ * The kernels work modulo the Fermat prime fitting `T`, i.e. 257 or 65537.
+ * Other rings, e.g. non-Fermat primes or binary extension fields, use the
+ * scalar implementation.
+ */
+template <typename T>
+const simd::FntKernels<T>* get_ring_kernels(T card)
 {
-    simd::neg(n, x, this->_card);
+    const T fermat_card = sizeof(T) == 2 ? 257 : 65537;
+    return card == fermat_card ? simd::get_fnt_kernels<T>() : nullptr;
 }
 
+} // namespace
+
 template <>
-void RingModN<uint32_t>::neg(size_t n, uint32_t* x) const
+void RingModN<uint16_t>::neg(size_t n, uint16_t* x) const
 {
-    simd::neg(n, x, this->_card);
+    const auto* kernels = get_ring_kernels<uint16_t>(this->_card);
+    if (kernels == nullptr) {
+        neg_slow(n, x);
+        return;
+    }
+    kernels->neg(n, x, this->_card);
 }
 
 template <>
-void RingModN<uint32_t>::mul_coef_to_buf(
-    uint32_t a,
-    uint32_t* src,
-    uint32_t* dest,
+void RingModN<uint16_t>::mul_coef_to_buf(
+    uint16_t a,
+    uint16_t* src,
+    uint16_t* dest,
     size_t len) const
 {
-    simd::mul_coef_to_buf(a, src, dest, len, this->_card);
+    const auto* kernels = get_ring_kernels<uint16_t>(this->_card);
+    if (kernels == nullptr) {
+        mul_coef_to_buf_slow(a, src, dest, len);
+        return;
+    }
+    kernels->mul_coef_to_buf(a, src, dest, len, this->_card);
 }
 
 template <>
-void RingModN<uint32_t>::add_two_bufs(uint32_t* src, uint32_t* dest, size_t len)
+void RingModN<uint16_t>::add_two_bufs(uint16_t* src, uint16_t* dest, size_t len)
     const
 {
-    simd::add_two_bufs(src, dest, len, this->_card);
+    const auto* kernels = get_ring_kernels<uint16_t>(this->_card);
+    if (kernels == nullptr) {
+        add_two_bufs_slow(src, dest, len);
+        return;
+    }
+    kernels->add_two_bufs(src, dest, len, this->_card);
 }
 
 template <>
-void RingModN<uint32_t>::sub_two_bufs(
-    uint32_t* bufa,
-    uint32_t* bufb,
-    uint32_t* res,
+void RingModN<uint16_t>::sub_two_bufs(
+    uint16_t* bufa,
+    uint16_t* bufb,
+    uint16_t* res,
     size_t len) const
 {
-    simd::sub_two_bufs(bufa, bufb, res, len, this->_card);
+    const auto* kernels = get_ring_kernels<uint16_t>(this->_card);
+    if (kernels == nullptr) {
+        sub_two_bufs_slow(bufa, bufb, res, len);
+        return;
+    }
+    kernels->sub_two_bufs(bufa, bufb, res, len, this->_card);
 }
 
 template <>
-void RingModN<uint16_t>::mul_coef_to_buf(
-    uint16_t a,
-    uint16_t* src,
-    uint16_t* dest,
-    size_t len) const
+void RingModN<uint16_t>::hadamard_mul(int n, uint16_t* x, uint16_t* y) const
 {
-    simd::mul_coef_to_buf(a, src, dest, len, this->_card);
+    const auto* kernels = get_ring_kernels<uint16_t>(this->_card);
+    if (kernels == nullptr) {
+        hadamard_mul_slow(n, x, y);
+        return;
+    }
+    kernels->mul_two_bufs(y, x, n, this->_card);
 }
 
 template <>
-void RingModN<uint16_t>::add_two_bufs(uint16_t* src, uint16_t* dest, size_t len)
-    const
+void RingModN<uint32_t>::neg(size_t n, uint32_t* x) const
 {
-    simd::add_two_bufs(src, dest, len, this->_card);
+    const auto* kernels = get_ring_kernels<uint32_t>(this->_card);
+    if (kernels == nullptr) {
+        neg_slow(n, x);
+        return;
+    }
+    kernels->neg(n, x, this->_card);
 }
 
 template <>
-void RingModN<uint16_t>::sub_two_bufs(
-    uint16_t* bufa,
-    uint16_t* bufb,
-    uint16_t* res,
+void RingModN<uint32_t>::mul_coef_to_buf(
+    uint32_t a,
+    uint32_t* src,
+    uint32_t* dest,
     size_t len) const
 {
-    simd::sub_two_bufs(bufa, bufb, res, len, this->_card);
+    const auto* kernels = get_ring_kernels<uint32_t>(this->_card);
+    if (kernels == nullptr) {
+        mul_coef_to_buf_slow(a, src, dest, len);
+        return;
+    }
+    kernels->mul_coef_to_buf(a, src, dest, len, this->_card);
 }
 
 template <>
-void RingModN<uint16_t>::hadamard_mul(int n, uint16_t* x_u16, uint16_t* y_u16)
+void RingModN<uint32_t>::add_two_bufs(uint32_t* src, uint32_t* dest, size_t len)
     const
 {
-    simd::mul_two_bufs(y_u16, x_u16, n, this->_card);
+    const auto* kernels = get_ring_kernels<uint32_t>(this->_card);
+    if (kernels == nullptr) {
+        add_two_bufs_slow(src, dest, len);
+        return;
+    }
+    kernels->add_two_bufs(src, dest, len, this->_card);
 }
 
 template <>
-void RingModN<uint32_t>::hadamard_mul(int n, uint32_t* x_u32, uint32_t* y_u32)
-    const
+void RingModN<uint32_t>::sub_two_bufs(
+    uint32_t* bufa,
+    uint32_t* bufb,
+    uint32_t* res,
+    size_t len) const
+{
+    const auto* kernels = get_ring_kernels<uint32_t>(this->_card);
+    if (kernels == nullptr) {
+        sub_two_bufs_slow(bufa, bufb, res, len);
+        return;
+    }
+    kernels->sub_two_bufs(bufa, bufb, res, len, this->_card);
+}
+
+template <>
+void RingModN<uint32_t>::hadamard_mul(int n, uint32_t* x, uint32_t* y) const
 {
-    simd::mul_two_bufs(y_u32, x_u32, n, this->_card);
+    const auto* kernels = get_ring_kernels<uint32_t>(this->_card);
+    if (kernels == nullptr) {
+        hadamard_mul_slow(n, x, y);
+        return;
+    }
+    kernels->mul_two_bufs(y, x, n, this->_card);
 }
 
 } // namespace gf
@@ -96,6 +96,7 @@ class RingModN {
     T log_naive(T base, T exponent) const;
     virtual T replicate(T a) const;
     virtual void mul_coef_to_buf(T a, T* src, T* dest, size_t len) const;
+    virtual void mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const;
     virtual void mul_vec_to_vecp(
         vec::Vector<T>& u,
         vec::Buffers<T>& src,
@@ -136,6 +137,13 @@ class RingModN {
     explicit RingModN(T card);
     virtual void init();
 
+    // Scalar implementations, also used when no SIMD kernel is available.
+    void mul_coef_to_buf_slow(T a, T* src, T* dest, size_t len) const;
+    void add_two_bufs_slow(T* src, T* dest, size_t len) const;
+    void sub_two_bufs_slow(T* bufa, T* bufb, T* res, size_t len) const;
+    void hadamard_mul_slow(int n, T* x, T* y) const;
+    void neg_slow(size_t n, T* x) const;
+
     template <typename Class, typename... Args>
     friend Class create(Args... args);
 
@@ -144,6 +152,8 @@ class RingModN {
 
     T _card;
     T root;
+    // multiplications by a constant use Shoup's method (see `arith::mul_shoup`)
+    bool shoup_mul = false;
     std::vector<T> primes;
     std::vector<int> exponents;
     std::vector<T> all_primes_factors;
@@ -362,8 +372,23 @@ inline T RingModN<T>::replicate(T a) const
 // For each i, dest[i] = a * src[i]
 template <typename T>
 inline void RingModN<T>::mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    mul_coef_to_buf_slow(a, src, dest, len);
+}
+
+template <typename T>
+inline void
+RingModN<T>::mul_coef_to_buf_slow(T a, T* src, T* dest, size_t len) const
 {
     size_t i;
+    if (shoup_mul) {
+        // the quotient of `a` is computed once, avoiding a division by element
+        const T a_shoup = arith::shoup_precompute<T>(a, this->_card);
+        for (i = 0; i < len; i++) {
+            dest[i] = arith::mul_shoup<T>(a, a_shoup, src[i], this->_card);
+        }
+        return;
+    }
     DoubleSizeVal<T> coef = DoubleSizeVal<T>(a);
     for (i = 0; i < len; i++) {
         // perform multiplication
@@ -371,6 +396,16 @@ inline void RingModN<T>::mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
     }
 }
 
+// For each i, dest[i] = dest[i] + a * src[i]
+template <typename T>
+inline void
+RingModN<T>::mul_coef_add_to_buf(T a, T* src, T* dest, size_t len) const
+{
+    for (size_t i = 0; i < len; i++) {
+        dest[i] = add(dest[i], mul(a, src[i]));
+    }
+}
+
 template <typename T>
 inline void RingModN<T>::mul_vec_to_vecp(
     vec::Vector<T>& u,
@@ -402,6 +437,12 @@ inline void RingModN<T>::mul_vec_to_vecp(
 
 template <typename T>
 inline void RingModN<T>::add_two_bufs(T* src, T* dest, size_t len) const
+{
+    add_two_bufs_slow(src, dest, len);
+}
+
+template <typename T>
+inline void RingModN<T>::add_two_bufs_slow(T* src, T* dest, size_t len) const
 {
     size_t i;
     for (i = 0; i < len; i++) {
@@ -427,6 +468,13 @@ RingModN<T>::add_vecp_to_vecp(vec::Buffers<T>& src, vec::Buffers<T>& dest) const
 template <typename T>
 inline void
 RingModN<T>::sub_two_bufs(T* bufa, T* bufb, T* res, size_t len) const
+{
+    sub_two_bufs_slow(bufa, bufb, res, len);
+}
+
+template <typename T>
+inline void
+RingModN<T>::sub_two_bufs_slow(T* bufa, T* bufb, T* res, size_t len) const
 {
     size_t i;
     for (i = 0; i < len; i++) {
@@ -823,6 +871,12 @@ T RingModN<T>::get_code_len_high_compo(T n) const
 
 template <typename T>
 inline void RingModN<T>::hadamard_mul(int n, T* x, T* y) const
+{
+    hadamard_mul_slow(n, x, y);
+}
+
+template <typename T>
+inline void RingModN<T>::hadamard_mul_slow(int n, T* x, T* y) const
 {
     for (int i = 0; i < n; i++) {
         x[i] = mul(x[i], y[i]);
@@ -831,6 +885,12 @@ inline void RingModN<T>::hadamard_mul(int n, T* x, T* y) const
 
 template <typename T>
 inline void RingModN<T>::neg(size_t n, T* x) const
+{
+    neg_slow(n, x);
+}
+
+template <typename T>
+inline void RingModN<T>::neg_slow(size_t n, T* x) const
 {
     // add y to the first half of `x`
     for (size_t i = 0; i < n; i++) {
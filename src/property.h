@@ -57,35 +57,79 @@ static constexpr unsigned OOR_MARK = 1;
  *  - value indicates value that could be used to adjust the symbol value
  * For prime fields, value is always 1.
  * For NF4, value is an uint32_t integer.
+ * Values are only stored once one of them differs from `OOR_MARK`.
  */
 class Properties {
   private:
-    std::vector<std::pair<size_t, uint32_t>> props;
+    // Locations of the values, and their markers. As most markers are
+    // `OOR_MARK`, markers are only stored once another one is added: until
+    // then `markers` is empty.
+    std::vector<size_t> locations;
+    std::vector<uint32_t> markers;
     size_t m_default_key = 0;
-    uint32_t m_default_val = 0;
 
     friend std::istream& operator>>(std::istream& is, Properties& props);
     friend std::ostream& operator<<(std::ostream& os, const Properties& props);
 
   public:
-    enum { FNT1 = 0x464E5431 };
+    enum { FNT1 = 0x464E5431, FNT2 = 0x464E5432 };
 
     /**
      * Add a pair of location and marker
      */
     inline void add(const size_t location, const uint32_t marker)
     {
-        props.push_back(std::make_pair(location, marker));
+        if (!markers.empty() || marker != OOR_MARK) {
+            markers.resize(locations.size(), OOR_MARK);
+            markers.push_back(marker);
+        }
+        locations.push_back(location);
     }
 
     inline void clear()
     {
-        props.clear();
+        locations.clear();
+        markers.clear();
+    }
+
+    /**
+     * Append all pairs of another Properties, keeping their order
+     */
+    inline void append(const Properties& other)
+    {
+        if (!markers.empty() || !other.markers.empty()) {
+            markers.resize(locations.size(), OOR_MARK);
+            if (other.markers.empty()) {
+                markers.resize(
+                    locations.size() + other.locations.size(), OOR_MARK);
+            } else {
+                markers.insert(
+                    markers.end(), other.markers.begin(), other.markers.end());
+            }
+        }
+        locations.insert(
+            locations.end(), other.locations.begin(), other.locations.end());
     }
 
-    const std::vector<std::pair<size_t, uint32_t>>& get_map() const
+    /**
+     * Return the number of pairs
+     */
+    inline size_t size() const
     {
-        return props;
+        return locations.size();
+    }
+
+    /**
+     * Return the pairs of location and marker
+     */
+    std::vector<std::pair<size_t, uint32_t>> get_map() const
+    {
+        std::vector<std::pair<size_t, uint32_t>> map;
+        map.reserve(locations.size());
+        for (size_t i = 0; i < locations.size(); ++i) {
+            map.emplace_back(locations[i], marker(i));
+        }
+        return map;
     }
 
     /**
@@ -93,23 +137,46 @@ class Properties {
      */
     inline void sort()
     {
-        std::sort(props.begin(), props.end());
+        if (markers.empty()) {
+            std::sort(locations.begin(), locations.end());
+            return;
+        }
+        std::vector<std::pair<size_t, uint32_t>> map = get_map();
+        std::sort(map.begin(), map.end());
+        for (size_t i = 0; i < map.size(); ++i) {
+            locations[i] = map[i].first;
+            markers[i] = map[i].second;
+        }
     }
 
     /**
      * Serialize properties into a buffer (FNT)
      *
+     * With `FNT1`, each location takes a dword. With `FNT2`, locations are
+     * stored as the LEB128 varints of their differences, i.e. 3 bytes for the
+     * usual distance between two out-of-range values.
+     *
+     * @param dwords buffer
+     * @param n_dwords size of the buffer
+     * @param format `FNT1` or `FNT2`
+     *
+     * @pre For `FNT2`, locations are sorted
+     *
      * @return 0 if OK, else -1
      */
-    inline int fnt_serialize(uint32_t* dwords, unsigned n_dwords)
+    inline int
+    fnt_serialize(uint32_t* dwords, unsigned n_dwords, uint32_t format = FNT1)
     {
-        if ((2 + props.size()) > n_dwords) {
+        if (format == FNT2) {
+            return fnt_serialize_compact(dwords, n_dwords);
+        }
+        if ((2 + locations.size()) > n_dwords) {
             return -1;
         }
         dwords[0] = htonl(FNT1);
         unsigned i = 2;
-        for (auto const& item : props) {
-            dwords[i++] = htonl(narrow_cast<uint32_t>(item.first));
+        for (auto const& location : locations) {
+            dwords[i++] = htonl(narrow_cast<uint32_t>(location));
         }
         dwords[1] = htonl(i - 2);
         std::fill(dwords + i, dwords + n_dwords - 1, htonl(0));
@@ -118,7 +185,7 @@ class Properties {
     }
 
     /**
-     * Deserialize properties from a buffer (FNT)
+     * Deserialize properties from a buffer (FNT), in any format
      *
      * @return 0 if OK, else -1
      */
@@ -128,6 +195,9 @@ class Properties {
             return -1;
         }
         uint32_t magic = ntohl(dwords[0]);
+        if (magic == FNT2) {
+            return fnt_deserialize_compact(dwords, n_dwords);
+        }
         if (magic != FNT1) {
             return -1;
         }
@@ -135,12 +205,30 @@ class Properties {
         if ((2 + _n_dwords) > n_dwords) {
             return -1;
         }
+        locations.reserve(locations.size() + _n_dwords);
         for (unsigned i = 0; i < _n_dwords; i++) {
             add(static_cast<size_t>(ntohl(dwords[i + 2])), OOR_MARK);
         }
         return 0;
     }
 
+    /**
+     * Find the first element whose location is not less than a given one
+     *
+     * @param loc - a location
+     *
+     * @pre `props` is sorted
+     *
+     * @returns index of the element if such element exists, otherwise the
+     * number of elements
+     */
+    inline size_t lower_bound(const size_t loc) const
+    {
+        const auto it =
+            std::lower_bound(locations.begin(), locations.end(), loc);
+        return static_cast<size_t>(it - locations.begin());
+    }
+
     /**
      * Get location at a given index
      *
@@ -151,7 +239,7 @@ class Properties {
      */
     inline const size_t& location(size_t index) const
     {
-        return (index < props.size()) ? props[index].first : m_default_key;
+        return (index < locations.size()) ? locations[index] : m_default_key;
     }
 
     /**
@@ -159,12 +247,14 @@ class Properties {
      *
      * @param index - index of element
      *
-     * @returns marker of the element if the element is found, otherwise a
-     * default value is return
+     * @returns marker of the element if the element is found, otherwise 0
      */
-    inline const uint32_t& marker(size_t index) const
+    inline uint32_t marker(size_t index) const
     {
-        return (index < props.size()) ? props[index].second : m_default_val;
+        if (index >= locations.size()) {
+            return 0;
+        }
+        return markers.empty() ? OOR_MARK : markers[index];
     }
 
     /**
@@ -177,7 +267,7 @@ class Properties {
      */
     inline bool is_marked(size_t index, const size_t loc) const
     {
-        return (index < props.size()) ? (props[index].first == loc) : false;
+        return (index < locations.size()) ? (locations[index] == loc) : false;
     }
 
     /**
@@ -191,10 +281,75 @@ class Properties {
      */
     inline bool in_range(size_t index, const size_t min, const size_t max) const
     {
-        return (index < props.size())
-                   ? (props[index].first >= min && props[index].first < max)
+        return (index < locations.size())
+                   ? (locations[index] >= min && locations[index] < max)
                    : false;
     }
+
+  private:
+    /**
+     * Serialize properties into a buffer in the `FNT2` format
+     *
+     * The buffer holds the magic, the number of locations, then the varints.
+     */
+    inline int fnt_serialize_compact(uint32_t* dwords, unsigned n_dwords)
+    {
+        if (n_dwords < 2) {
+            return -1;
+        }
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(dwords + 2);
+        const size_t n_bytes = (n_dwords - 2) * sizeof(uint32_t);
+        size_t pos = 0;
+        size_t prev = 0;
+        for (auto const& location : locations) {
+            assert(location >= prev);
+            uint64_t delta = location - prev;
+            do {
+                if (pos == n_bytes) {
+                    return -1;
+                }
+                const uint8_t byte = delta & 0x7F;
+                delta >>= 7;
+                bytes[pos++] = delta ? (byte | 0x80) : byte;
+            } while (delta);
+            prev = location;
+        }
+        dwords[0] = htonl(FNT2);
+        dwords[1] = htonl(narrow_cast<uint32_t>(locations.size()));
+        std::fill(bytes + pos, bytes + n_bytes, 0);
+
+        return 0;
+    }
+
+    /**
+     * Deserialize properties from a buffer in the `FNT2` format
+     */
+    inline int
+    fnt_deserialize_compact(const uint32_t* dwords, unsigned n_dwords)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(dwords + 2);
+        const size_t n_bytes = (n_dwords - 2) * sizeof(uint32_t);
+        const uint32_t count = ntohl(dwords[1]);
+        size_t pos = 0;
+        size_t location = 0;
+        locations.reserve(locations.size() + count);
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t delta = 0;
+            unsigned shift = 0;
+            uint8_t byte;
+            do {
+                if (pos == n_bytes || shift >= 64) {
+                    return -1;
+                }
+                byte = bytes[pos++];
+                delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            location += delta;
+            add(location, OOR_MARK);
+        }
+        return 0;
+    }
 };
 
 class FntProperties : public Properties {
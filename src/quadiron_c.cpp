@@ -28,38 +28,345 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <random>
+#include <tuple>
+#include <vector>
+
 #include "property.h"
 #include "quadiron.h"
 #include "quadiron_c.h"
 
+/** An FNT codec along with the scratch arrays of the C API calls
+ *
+ * The arrays are sized at creation and reused by each call, hence steady
+ * state calls do not allocate.
+ */
+struct QuadironFnt32 {
+    QuadironFnt32(
+        quadiron::fec::FecType type,
+        unsigned word_size,
+        unsigned n_data,
+        unsigned n_parities,
+        size_t pkt_size)
+        : fec(type, word_size, n_data, n_parities, pkt_size),
+          data_vec(fec.n_data), parities_vec(fec.n_outputs),
+          parities_props(fec.n_outputs), missing_idxs_vec(fec.code_len),
+          wanted_data_vec(fec.n_data), wanted_idxs_vec(fec.n_outputs)
+    {
+    }
+
+    quadiron::fec::RsFnt<uint32_t> fec;
+    std::vector<uint8_t*> data_vec;
+    std::vector<uint8_t*> parities_vec;
+    std::vector<quadiron::Properties> parities_props;
+    std::vector<int> missing_idxs_vec;
+    std::vector<bool> wanted_data_vec;
+    std::vector<bool> wanted_idxs_vec;
+    // properties of the fragment rebuilt by a reconstruction
+    quadiron::Properties repair_props;
+    // format of the metadata, `Properties::FNT1` or `Properties::FNT2`
+    uint32_t metadata_format = quadiron::Properties::FNT1;
+    // arrays of each stripe of a batch, resized when the batch size changes
+    std::vector<std::vector<uint8_t*>> stripes_data_vec;
+    std::vector<std::vector<uint8_t*>> stripes_parities_vec;
+    std::vector<std::vector<quadiron::Properties>> stripes_props;
+
+    /** Reset the scratch arrays before a call
+     *
+     * @param missing_idxs array of missing fragments (code_len items), or
+     * nullptr if not relevant
+     */
+    void reset(const int* missing_idxs)
+    {
+        std::fill(data_vec.begin(), data_vec.end(), nullptr);
+        std::fill(parities_vec.begin(), parities_vec.end(), nullptr);
+        for (auto& props : parities_props) {
+            props.clear();
+        }
+        if (missing_idxs) {
+            std::copy(
+                missing_idxs,
+                missing_idxs + fec.code_len,
+                missing_idxs_vec.begin());
+        }
+        std::fill(wanted_data_vec.begin(), wanted_data_vec.end(), false);
+        std::fill(wanted_idxs_vec.begin(), wanted_idxs_vec.end(), false);
+    }
+};
+
+namespace {
+
+static_assert(
+    QUADIRON_N_STAGES == quadiron::fec::N_STAGES,
+    "C and C++ stages differ");
+static_assert(
+    QUADIRON_STAGE_COPY == static_cast<unsigned>(quadiron::fec::Stage::COPY),
+    "C and C++ stages are not in the same order");
+
+// Packet size of the instances created by `quadiron_fnt32_new`
+constexpr size_t DEFAULT_PKT_SIZE = 1024;
+
+// Packet sizes tried by the auto-tuning
+constexpr size_t TUNED_PKT_SIZES[] = {256, 512, 1024, 2048, 4096};
+
+// Number of the largest packets in the blocks encoded by the auto-tuning
+constexpr size_t TUNING_N_PKTS = 8;
+
+// Number of timed encodings of each packet size, the fastest one is kept
+constexpr unsigned TUNING_N_RUNS = 3;
+
+/** Return the packet size encoding the fastest with the given parameters
+ *
+ * Blocks of random data are encoded with each candidate size. Results are
+ * cached per parameters.
+ */
+size_t tune_pkt_size(
+    quadiron::fec::FecType type,
+    unsigned word_size,
+    unsigned n_data,
+    unsigned n_parities)
+{
+    using Params =
+        std::tuple<quadiron::fec::FecType, unsigned, unsigned, unsigned>;
+    static std::mutex mutex;
+    static std::map<Params, size_t> tuned;
+
+    const Params params(type, word_size, n_data, n_parities);
+    std::lock_guard<std::mutex> guard(mutex);
+    const auto it = tuned.find(params);
+    if (it != tuned.end()) {
+        return it->second;
+    }
+
+    const size_t max_pkt_size = *std::max_element(
+        std::begin(TUNED_PKT_SIZES), std::end(TUNED_PKT_SIZES));
+    const size_t block_size = TUNING_N_PKTS * max_pkt_size * word_size;
+
+    std::minstd_rand prng;
+    std::vector<std::vector<uint8_t>> data(
+        n_data, std::vector<uint8_t>(block_size));
+    std::vector<uint8_t*> data_bufs(n_data);
+    for (unsigned i = 0; i < n_data; i++) {
+        for (auto& byte : data[i]) {
+            byte = static_cast<uint8_t>(prng());
+        }
+        data_bufs[i] = data[i].data();
+    }
+
+    size_t best_pkt_size = DEFAULT_PKT_SIZE;
+    auto best_time = std::chrono::steady_clock::duration::max();
+    for (const size_t pkt_size : TUNED_PKT_SIZES) {
+        quadiron::fec::RsFnt<uint32_t> fec(
+            type, word_size, n_data, n_parities, pkt_size);
+
+        std::vector<std::vector<uint8_t>> parities(
+            fec.n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> parities_bufs(fec.n_outputs);
+        for (unsigned i = 0; i < fec.n_outputs; i++) {
+            parities_bufs[i] = parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(fec.n_outputs);
+        std::vector<bool> wanted_idxs(fec.n_outputs, true);
+
+        // The first encoding warms up caches and scratch memory.
+        for (unsigned run = 0; run <= TUNING_N_RUNS; run++) {
+            const auto start = std::chrono::steady_clock::now();
+            fec.encode_blocks_vertical(
+                data_bufs, parities_bufs, props, wanted_idxs, block_size);
+            const auto time = std::chrono::steady_clock::now() - start;
+            if (run > 0 && time < best_time) {
+                best_time = time;
+                best_pkt_size = pkt_size;
+            }
+        }
+    }
+
+    tuned[params] = best_pkt_size;
+    return best_pkt_size;
+}
+
+/** Fill the block arrays given to `encode_blocks_vertical`
+ *
+ * Blocks begin with their metadata, which are skipped. Parity blocks that are
+ * not wanted may be NULL.
+ */
+void bind_encode_blocks(
+    const quadiron::fec::RsFnt<uint32_t>& fec,
+    uint8_t** data,
+    uint8_t** parity,
+    int metadata_size,
+    std::vector<uint8_t*>& data_vec,
+    std::vector<uint8_t*>& parities_vec)
+{
+    if (fec.type == quadiron::fec::FecType::SYSTEMATIC) {
+        for (unsigned i = 0; i < fec.n_data; i++) {
+            data_vec[i] = data[i] + metadata_size;
+        }
+        for (unsigned i = 0; i < fec.n_parities; i++) {
+            parities_vec[i] = parity[i] ? parity[i] + metadata_size : nullptr;
+        }
+    } else {
+        for (unsigned i = 0; i < fec.n_data; i++) {
+            data_vec[i] = data[i] + metadata_size;
+            parities_vec[i] = data[i] + metadata_size;
+        }
+        for (unsigned i = 0; i < fec.n_parities; i++) {
+            parities_vec[fec.n_data + i] =
+                parity[i] ? parity[i] + metadata_size : nullptr;
+        }
+    }
+}
+
+/** Serialize properties into the metadata heading a block
+ *
+ * The compact format requires sorted locations, hence properties are sorted
+ * first.
+ *
+ * @return 0 if OK, else -1
+ */
+int store_props(
+    quadiron::Properties& props,
+    uint8_t* block,
+    int metadata_size,
+    uint32_t format)
+{
+    if (format == quadiron::Properties::FNT2) {
+        props.sort();
+    }
+    uint32_t* metadata = reinterpret_cast<uint32_t*>(block);
+    return props.fnt_serialize(metadata, metadata_size / 4, format);
+}
+
+/** Serialize the properties of an encoding into the metadata of the blocks
+ *
+ * Blocks of the outputs that are not wanted are left untouched.
+ *
+ * @return 0 if OK, else -1
+ */
+int store_encode_props(
+    const quadiron::fec::RsFnt<uint32_t>& fec,
+    uint8_t** data,
+    uint8_t** parity,
+    int metadata_size,
+    uint32_t format,
+    const std::vector<bool>& wanted_idxs,
+    std::vector<quadiron::Properties>& parities_props)
+{
+    if (fec.type == quadiron::fec::FecType::SYSTEMATIC) {
+        quadiron::Properties null_prop;
+
+        for (unsigned i = 0; i < fec.n_data; i++) {
+            int ret = store_props(null_prop, data[i], metadata_size, format);
+            if (ret == -1) {
+                return -1;
+            }
+        }
+        for (unsigned i = 0; i < fec.n_parities; i++) {
+            if (!wanted_idxs[i]) {
+                continue;
+            }
+            int ret = store_props(
+                parities_props[i], parity[i], metadata_size, format);
+            if (ret == -1) {
+                return -1;
+            }
+        }
+    } else {
+        for (unsigned i = 0; i < fec.n_data; i++) {
+            if (!wanted_idxs[i]) {
+                continue;
+            }
+            int ret = store_props(
+                parities_props[i], data[i], metadata_size, format);
+            if (ret == -1) {
+                return -1;
+            }
+        }
+        for (unsigned i = 0; i < fec.n_parities; i++) {
+            if (!wanted_idxs[fec.n_data + i]) {
+                continue;
+            }
+            int ret = store_props(
+                parities_props[fec.n_data + i],
+                parity[i],
+                metadata_size,
+                format);
+            if (ret == -1) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/** Return the block holding an output of the encoding
+ *
+ * For non-systematic codes, the first outputs are stored in the data blocks.
+ */
+uint8_t* get_output_block(
+    const quadiron::fec::RsFnt<uint32_t>& fec,
+    uint8_t** data,
+    uint8_t** parity,
+    unsigned output_idx)
+{
+    if (fec.type == quadiron::fec::FecType::SYSTEMATIC) {
+        return parity[output_idx];
+    }
+    return output_idx < fec.n_data ? data[output_idx]
+                                   : parity[output_idx - fec.n_data];
+}
+
+} // namespace
+
 extern "C" {
 
 struct QuadironFnt32*
 quadiron_fnt32_new(int word_size, int n_data, int n_parities, int systematic)
 {
-    const size_t pkt_size = 1024;
-
-    if (word_size == 1 || word_size == 2) {
-        return reinterpret_cast<struct QuadironFnt32*>(
-            new quadiron::fec::RsFnt<uint32_t>(
-                systematic ? quadiron::fec::FecType::SYSTEMATIC
-                           : quadiron::fec::FecType::NON_SYSTEMATIC,
-                word_size,
-                n_data,
-                n_parities,
-                pkt_size));
+    return quadiron_fnt32_new_ex(
+        word_size, n_data, n_parities, systematic, DEFAULT_PKT_SIZE);
+}
+
+struct QuadironFnt32* quadiron_fnt32_new_ex(
+    int word_size,
+    int n_data,
+    int n_parities,
+    int systematic,
+    size_t pkt_size)
+{
+    if (word_size != 1 && word_size != 2) {
+        return nullptr;
+    }
+
+    const quadiron::fec::FecType type =
+        systematic ? quadiron::fec::FecType::SYSTEMATIC
+                   : quadiron::fec::FecType::NON_SYSTEMATIC;
+
+    if (pkt_size == QUADIRON_PKT_SIZE_AUTO) {
+        pkt_size = tune_pkt_size(type, word_size, n_data, n_parities);
     }
 
-    return nullptr;
+    return new QuadironFnt32(type, word_size, n_data, n_parities, pkt_size);
+}
+
+size_t quadiron_fnt32_get_pkt_size(struct QuadironFnt32* fecp)
+{
+    return fecp->fec.pkt_size;
 }
 
 void quadiron_fnt32_delete(struct QuadironFnt32* fecp)
 {
-    delete reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
+    delete fecp;
 }
 
 int quadiron_fnt32_get_metadata_size(
-    struct QuadironFnt32* /* fecp */,
+    struct QuadironFnt32* fecp,
     size_t block_size)
 {
     /*
@@ -67,7 +374,31 @@ int quadiron_fnt32_get_metadata_size(
      * We count 4 bytes per special value.
      * We see large and roundup by 16 items.
      */
-    return ((block_size / 65536) + 16) * 4;
+    const size_t n_values = (block_size / 65536) + 16;
+
+    if (fecp->metadata_format == quadiron::Properties::FNT2) {
+        /*
+         * Special values are about 65536 words apart, hence 3 bytes per
+         * value. We add a header of 8 bytes, and 3 bytes for a longer gap.
+         */
+        const size_t n_bytes = 8 + 3 * n_values + 3;
+        return ((n_bytes + 3) / 4) * 4;
+    }
+    return n_values * 4;
+}
+
+int quadiron_fnt32_set_metadata_format(struct QuadironFnt32* fecp, int format)
+{
+    switch (format) {
+    case QUADIRON_METADATA_FNT1:
+        fecp->metadata_format = quadiron::Properties::FNT1;
+        return 0;
+    case QUADIRON_METADATA_FNT2:
+        fecp->metadata_format = quadiron::Properties::FNT2;
+        return 0;
+    default:
+        return -1;
+    }
 }
 
 int quadiron_fnt32_encode(
@@ -77,69 +408,138 @@ int quadiron_fnt32_encode(
     int* wanted_idxs,
     size_t block_size)
 {
-    quadiron::fec::RsFnt<uint32_t>* fec =
-        reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
-    std::vector<uint8_t*> data_vec(fec->n_data, nullptr);
-    std::vector<uint8_t*> parities_vec(fec->n_outputs, nullptr);
-    std::vector<quadiron::Properties> parities_props(fec->n_outputs);
-    std::vector<bool> wanted_idxs_vec(fec->n_outputs);
+    quadiron::fec::RsFnt<uint32_t>* fec = &fecp->fec;
+    fecp->reset(nullptr);
+    std::vector<uint8_t*>& data_vec = fecp->data_vec;
+    std::vector<uint8_t*>& parities_vec = fecp->parities_vec;
+    std::vector<quadiron::Properties>& parities_props = fecp->parities_props;
+    std::vector<bool>& wanted_idxs_vec = fecp->wanted_idxs_vec;
     int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
 
     for (unsigned i = 0; i < fec->n_outputs; i++) {
         wanted_idxs_vec[i] = wanted_idxs[i] ? true : false;
     }
 
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            data_vec[i] = data[i] + metadata_size;
-        }
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            parities_vec[i] = parity[i] + metadata_size;
-        }
-    } else {
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            data_vec[i] = data[i] + metadata_size;
-            parities_vec[i] = data[i] + metadata_size;
-        }
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            parities_vec[fec->n_data + i] = parity[i] + metadata_size;
-        }
-    }
+    bind_encode_blocks(
+        *fec, data, parity, metadata_size, data_vec, parities_vec);
 
     fec->encode_blocks_vertical(
         data_vec, parities_vec, parities_props, wanted_idxs_vec, block_size);
 
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        quadiron::Properties null_prop;
+    return store_encode_props(
+        *fec,
+        data,
+        parity,
+        metadata_size,
+        fecp->metadata_format,
+        wanted_idxs_vec,
+        parities_props);
+}
 
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            uint32_t* metadata = reinterpret_cast<uint32_t*>(data[i]);
-            int ret = null_prop.fnt_serialize(metadata, metadata_size / 4);
-            if (ret == -1) {
-                return -1;
-            }
-        }
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            uint32_t* metadata = reinterpret_cast<uint32_t*>(parity[i]);
-            int ret =
-                parities_props[i].fnt_serialize(metadata, metadata_size / 4);
-            if (ret == -1) {
-                return -1;
-            }
+int quadiron_fnt32_encode_batch(
+    struct QuadironFnt32* fecp,
+    uint8_t*** data,
+    uint8_t*** parity,
+    int* wanted_idxs,
+    size_t n_stripes,
+    size_t block_size)
+{
+    quadiron::fec::RsFnt<uint32_t>* fec = &fecp->fec;
+    fecp->reset(nullptr);
+    std::vector<bool>& wanted_idxs_vec = fecp->wanted_idxs_vec;
+    int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
+
+    for (unsigned i = 0; i < fec->n_outputs; i++) {
+        wanted_idxs_vec[i] = wanted_idxs[i] ? true : false;
+    }
+
+    if (fecp->stripes_data_vec.size() != n_stripes) {
+        fecp->stripes_data_vec.resize(
+            n_stripes, std::vector<uint8_t*>(fec->n_data));
+        fecp->stripes_parities_vec.resize(
+            n_stripes, std::vector<uint8_t*>(fec->n_outputs));
+        fecp->stripes_props.resize(
+            n_stripes, std::vector<quadiron::Properties>(fec->n_outputs));
+    }
+
+    for (size_t s = 0; s < n_stripes; s++) {
+        bind_encode_blocks(
+            *fec,
+            data[s],
+            parity[s],
+            metadata_size,
+            fecp->stripes_data_vec[s],
+            fecp->stripes_parities_vec[s]);
+    }
+
+    fec->encode_stripes_vertical(
+        fecp->stripes_data_vec,
+        fecp->stripes_parities_vec,
+        fecp->stripes_props,
+        wanted_idxs_vec,
+        block_size);
+
+    for (size_t s = 0; s < n_stripes; s++) {
+        int ret = store_encode_props(
+            *fec,
+            data[s],
+            parity[s],
+            metadata_size,
+            fecp->metadata_format,
+            wanted_idxs_vec,
+            fecp->stripes_props[s]);
+        if (ret == -1) {
+            return -1;
         }
-    } else {
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            uint32_t* metadata = reinterpret_cast<uint32_t*>(data[i]);
+    }
+
+    return 0;
+}
+
+int quadiron_fnt32_update(
+    struct QuadironFnt32* fecp,
+    unsigned int data_idx,
+    const uint8_t* old_data,
+    const uint8_t* new_data,
+    uint8_t** data,
+    uint8_t** parity,
+    int* wanted_idxs,
+    size_t block_size)
+{
+    quadiron::fec::RsFnt<uint32_t>* fec = &fecp->fec;
+    fecp->reset(nullptr);
+    std::vector<uint8_t*>& parities_vec = fecp->parities_vec;
+    std::vector<quadiron::Properties>& parities_props = fecp->parities_props;
+    int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
+
+    if (data_idx >= fec->n_data) {
+        return -1;
+    }
+
+    for (unsigned i = 0; i < fec->n_outputs; i++) {
+        if (wanted_idxs[i]) {
+            uint8_t* block = get_output_block(*fec, data, parity, i);
+            uint32_t* metadata = reinterpret_cast<uint32_t*>(block);
             int ret =
-                parities_props[i].fnt_serialize(metadata, metadata_size / 4);
+                parities_props[i].fnt_deserialize(metadata, metadata_size / 4);
             if (ret == -1) {
                 return -1;
             }
+            parities_vec[i] = block + metadata_size;
         }
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            uint32_t* metadata = reinterpret_cast<uint32_t*>(parity[i]);
-            int ret = parities_props[fec->n_data + i].fnt_serialize(
-                metadata, metadata_size / 4);
+    }
+
+    fec->update_parities(
+        data_idx, old_data, new_data, parities_vec, parities_props, block_size);
+
+    for (unsigned i = 0; i < fec->n_outputs; i++) {
+        if (wanted_idxs[i]) {
+            uint8_t* block = get_output_block(*fec, data, parity, i);
+            int ret = store_props(
+                parities_props[i],
+                block,
+                metadata_size,
+                fecp->metadata_format);
             if (ret == -1) {
                 return -1;
             }
@@ -156,14 +556,14 @@ int quadiron_fnt32_decode(
     int* missing_idxs,
     size_t block_size)
 {
-    quadiron::fec::RsFnt<uint32_t>* fec =
-        reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
-    std::vector<uint8_t*> data_vec(fec->n_data, nullptr);
-    std::vector<uint8_t*> parities_vec(fec->n_outputs, nullptr);
-    std::vector<quadiron::Properties> parities_props(fec->n_outputs);
-    std::vector<int> missing_idxs_vec(
-        missing_idxs, missing_idxs + fec->code_len);
-    std::vector<bool> wanted_idxs_vec(fec->n_data, true);
+    quadiron::fec::RsFnt<uint32_t>* fec = &fecp->fec;
+    fecp->reset(missing_idxs);
+    std::vector<uint8_t*>& data_vec = fecp->data_vec;
+    std::vector<uint8_t*>& parities_vec = fecp->parities_vec;
+    std::vector<quadiron::Properties>& parities_props = fecp->parities_props;
+    std::vector<int>& missing_idxs_vec = fecp->missing_idxs_vec;
+    std::vector<bool>& wanted_idxs_vec = fecp->wanted_data_vec;
+    std::fill(wanted_idxs_vec.begin(), wanted_idxs_vec.end(), true);
     int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
     bool res;
 
@@ -218,8 +618,8 @@ int quadiron_fnt32_decode(
     // reset metadata of data
     for (unsigned i = 0; i < fec->n_data; i++) {
         parities_props[i].clear();
-        uint32_t* metadata = reinterpret_cast<uint32_t*>(data[i]);
-        int ret = parities_props[i].fnt_serialize(metadata, metadata_size / 4);
+        int ret = store_props(
+            parities_props[i], data[i], metadata_size, fecp->metadata_format);
         if (ret == -1) {
             return -1;
         }
@@ -236,21 +636,20 @@ int quadiron_fnt32_reconstruct(
     unsigned int destination_idx,
     size_t block_size)
 {
-    quadiron::fec::RsFnt<uint32_t>* fec =
-        reinterpret_cast<quadiron::fec::RsFnt<uint32_t>*>(fecp);
-    std::vector<uint8_t*> data_vec(fec->n_data);
-    std::vector<uint8_t*> parities_vec(fec->n_outputs);
-    std::vector<quadiron::Properties> parities_props(fec->n_outputs);
-    std::vector<int> missing_idxs_vec(
-        missing_idxs, missing_idxs + fec->code_len);
-    std::vector<bool> wanted_data_vec(fec->n_data, false);
-    std::vector<bool> wanted_idxs_vec(fec->n_outputs, false);
+    quadiron::fec::RsFnt<uint32_t>* fec = &fecp->fec;
+    fecp->reset(missing_idxs);
+    std::vector<uint8_t*>& data_vec = fecp->data_vec;
+    std::vector<uint8_t*>& parities_vec = fecp->parities_vec;
+    std::vector<quadiron::Properties>& parities_props = fecp->parities_props;
+    std::vector<int>& missing_idxs_vec = fecp->missing_idxs_vec;
     int metadata_size = quadiron_fnt32_get_metadata_size(fecp, block_size);
     bool res;
 
     if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
         for (unsigned i = 0; i < fec->n_data; i++) {
-            data_vec[i] = data[i] + metadata_size;
+            if (!missing_idxs[i]) {
+                data_vec[i] = data[i] + metadata_size;
+            }
         }
         for (unsigned i = 0; i < fec->n_parities; i++) {
             if (!missing_idxs[fec->n_data + i]) {
@@ -285,126 +684,64 @@ int quadiron_fnt32_reconstruct(
         }
     }
 
-    int need_decode = 0;
-
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        /*
-         * Easy case where the target is a data then simply decode
-         */
-        if (destination_idx < fec->n_data) {
-            wanted_idxs_vec[destination_idx] = true;
-            res = fec->decode_blocks_vertical(
-                data_vec,
-                parities_vec,
-                parities_props,
-                missing_idxs_vec,
-                wanted_idxs_vec,
-                block_size);
-            if (!res) {
-                return -1;
-            }
-            for (unsigned i = 0; i < fec->n_data; i++) {
-                quadiron::Properties null_prop;
-
-                if (i == destination_idx) {
-                    uint32_t* metadata = reinterpret_cast<uint32_t*>(data[i]);
-                    int ret =
-                        null_prop.fnt_serialize(metadata, metadata_size / 4);
-                    if (ret == -1) {
-                        return -1;
-                    }
-                }
-            }
-            return 0;
-        }
+    if (destination_idx >= fec->code_len) {
+        return -1;
     }
 
     /*
-     * At this point we want a parity to be reconstructed
-     * If systematic we may need to decode if a data is missing.
-     * If non-systematic we always need to decode
+     * Only the destination is computed, from n_data available fragments.
      */
-    std::vector<std::vector<uint8_t>> blocks(fec->n_data);
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            if (missing_idxs[i]) {
-                need_decode = 1;
-                wanted_data_vec[i] = true;
-                blocks.at(i).resize(block_size);
-                data_vec[i] = blocks.at(i).data();
-            }
-        }
-    } else {
-        need_decode = 1;
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            wanted_data_vec[i] = true;
-            blocks.at(i).resize(block_size);
-            data_vec[i] = blocks.at(i).data();
-        }
-    }
-
-    if (need_decode) {
-        res = fec->decode_blocks_vertical(
-            data_vec,
-            parities_vec,
-            parities_props,
-            missing_idxs_vec,
-            wanted_data_vec,
-            block_size);
-        if (!res) {
-            return -1;
-        }
+    uint8_t* dest = destination_idx < fec->n_data
+                        ? data[destination_idx]
+                        : parity[destination_idx - fec->n_data];
+    quadiron::Properties& dest_props = fecp->repair_props;
+    res = fec->repair_block_vertical(
+        destination_idx,
+        data_vec,
+        parities_vec,
+        parities_props,
+        missing_idxs_vec,
+        dest + metadata_size,
+        dest_props,
+        block_size);
+    if (!res) {
+        return -1;
     }
 
-    /*
-     * At this point we have all data blocks.
-     */
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        wanted_idxs_vec[destination_idx - fec->n_data] = true;
-    } else {
-        wanted_idxs_vec[destination_idx] = true;
-    }
+    // Data of systematic codes have no properties, hence `dest_props` is
+    // empty for them.
+    return store_props(dest_props, dest, metadata_size, fecp->metadata_format);
+}
 
-    fec->encode_blocks_vertical(
-        data_vec, parities_vec, parities_props, wanted_idxs_vec, block_size);
+void quadiron_fnt32_enable_stats(struct QuadironFnt32* fecp, int enabled)
+{
+    fecp->fec.set_stage_stats(enabled != 0);
+}
 
-    if (fec->type == quadiron::fec::FecType::SYSTEMATIC) {
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            if (i == destination_idx - fec->n_data) {
-                uint32_t* metadata = reinterpret_cast<uint32_t*>(parity[i]);
-                int ret = parities_props[i].fnt_serialize(
-                    metadata, metadata_size / 4);
-                if (ret == -1) {
-                    return -1;
-                }
-            }
-        }
-    } else {
-        for (unsigned i = 0; i < fec->n_data; i++) {
-            if (i == destination_idx) {
-                uint32_t* metadata = reinterpret_cast<uint32_t*>(data[i]);
-                int ret = parities_props[i].fnt_serialize(
-                    metadata, metadata_size / 4);
-                if (ret == -1) {
-                    return -1;
-                }
-            }
-        }
-        for (unsigned i = 0; i < fec->n_parities; i++) {
-            if (fec->n_data + i == destination_idx) {
-                uint32_t* metadata = reinterpret_cast<uint32_t*>(parity[i]);
-                int ret = parities_props[fec->n_data + i].fnt_serialize(
-                    metadata, metadata_size / 4);
-                if (ret == -1) {
-                    return -1;
-                }
-            }
-        }
+int quadiron_fnt32_get_stats(
+    struct QuadironFnt32* fecp,
+    struct QuadironStageStats* stats,
+    size_t n_stats)
+{
+    const quadiron::fec::StageStats* stage_stats = fecp->fec.get_stage_stats();
+    if (stage_stats == nullptr) {
+        return -1;
     }
 
+    const size_t n = std::min<size_t>(n_stats, QUADIRON_N_STAGES);
+    for (size_t i = 0; i < n; ++i) {
+        const auto stage = static_cast<quadiron::fec::Stage>(i);
+        stats[i].cycles = stage_stats->get_cycles(stage);
+        stats[i].calls = stage_stats->get_calls(stage);
+    }
     return 0;
 }
 
+void quadiron_fnt32_reset_stats(struct QuadironFnt32* fecp)
+{
+    fecp->fec.reset_stage_stats();
+}
+
 void quadiron_hex_dump(uint8_t* buf, size_t size)
 {
     quadiron::hex_dump(std::cerr, buf, size, true);
@@ -49,6 +49,41 @@ extern "C" {
 struct QuadironFnt32*
 quadiron_fnt32_new(int word_size, int n_data, int n_parities, int systematic);
 
+/** Packet size asking `quadiron_fnt32_new_ex` to pick the fastest one */
+#define QUADIRON_PKT_SIZE_AUTO 0
+
+/** Create FNT FEC with a given packet size
+ *
+ * The best packet size depends on the code parameters and on the cache sizes
+ * of the host. With `QUADIRON_PKT_SIZE_AUTO`, a small encoding benchmark is run
+ * over candidate sizes and the fastest one is kept. Its result is remembered
+ * for the next instances created with the same parameters.
+ *
+ * @param[in] word_size FNT only supports 1 or 2
+ * @param[in] n_data number of data fragments
+ * @param[in] n_parities number of parity fragments
+ * @param[in] systematic if 1 then the code is systematic otherwise
+ * non-systematic
+ * @param[in] pkt_size number of words encoded at once, or
+ * `QUADIRON_PKT_SIZE_AUTO`
+ *
+ * @return the FEC instance pointer
+ */
+struct QuadironFnt32* quadiron_fnt32_new_ex(
+    int word_size,
+    int n_data,
+    int n_parities,
+    int systematic,
+    size_t pkt_size);
+
+/** Return the packet size used by the FEC
+ *
+ * @param[in] fecp the FEC instance
+ *
+ * @return the number of words encoded at once
+ */
+size_t quadiron_fnt32_get_pkt_size(struct QuadironFnt32* fecp);
+
 /** Delete FEC
  *
  * @param[in,out] fecp the FEC instance pointer
@@ -69,6 +104,26 @@ int quadiron_fnt32_get_metadata_size(
     struct QuadironFnt32* fecp,
     size_t block_size);
 
+/** Formats of the metadata heading the blocks */
+enum QuadironMetadataFormat {
+    /** One dword per special value (default) */
+    QUADIRON_METADATA_FNT1 = 1,
+    /** Delta-encoded varints, about 3 bytes per special value */
+    QUADIRON_METADATA_FNT2 = 2,
+};
+
+/** Set the format of the metadata written by the FEC
+ *
+ * Blocks of both formats are read, but the format changes the metadata size:
+ * blocks must be encoded and decoded with the same format.
+ *
+ * @param[in] fecp the FEC instance
+ * @param[in] format a QuadironMetadataFormat
+ *
+ * @return 0 if succeeded, else -1 (unknown format)
+ */
+int quadiron_fnt32_set_metadata_format(struct QuadironFnt32* fecp, int format);
+
 /** Encode blocks
  *
  * @param[in] fecp the FEC instance
@@ -80,7 +135,8 @@ int quadiron_fnt32_get_metadata_size(
  * - n_outputs is n_parities if systematic, and n_data + n_parities if
  * non-systematic
  * @param[in] wanted_idxs array of length n_outputs indicating
- * the wish (value 1) or not (value 0) of parities
+ * the wish (value 1) or not (value 0) of parities. When only a few are
+ * wanted, the others are not computed.
  * @param[in] block_size the block size in bytes
  *
  * @return 0 if encode succeeded, else -1
@@ -92,6 +148,63 @@ int quadiron_fnt32_encode(
     int* wanted_idxs,
     size_t block_size);
 
+/** Encode a batch of stripes
+ *
+ * It gives the same result as calling `quadiron_fnt32_encode` on each stripe,
+ * but is faster for small blocks as the setup of the encoding is shared by the
+ * stripes.
+ *
+ * @param[in] fecp the FEC instance
+ * @param[in] data data blocks of each stripe, see `quadiron_fnt32_encode`
+ * @param[out] parity parity blocks of each stripe
+ * @param[in] wanted_idxs array of length n_outputs indicating
+ * the wish (value 1) or not (value 0) of parities, for all stripes
+ * @param[in] n_stripes number of stripes
+ * @param[in] block_size the block size in bytes, the same for all stripes
+ *
+ * @return 0 if encode succeeded, else -1
+ */
+int quadiron_fnt32_encode_batch(
+    struct QuadironFnt32* fecp,
+    uint8_t*** data,
+    uint8_t*** parity,
+    int* wanted_idxs,
+    size_t n_stripes,
+    size_t block_size);
+
+/** Update parities after a data block was overwritten
+ *
+ * Parities are updated in place, along with their metadata, from the old and
+ * new content of the data block only. This is much cheaper than encoding the
+ * stripe again when a single data block changes.
+ *
+ * @param[in] fecp the FEC instance
+ * @param[in] data_idx index of the overwritten data block
+ * @param[in] old_data previous content of the data block, block_size bytes
+ * without metadata
+ * @param[in] new_data new content of the data block, block_size bytes without
+ * metadata
+ * @param[in,out] data for non-systematic codes, the blocks given to
+ * `quadiron_fnt32_encode`, ignored for systematic codes
+ * @param[in,out] parity must be exactly n_parities
+ * - set entries to NULL when not wanted
+ * @param[in] wanted_idxs array of length n_outputs indicating
+ * the wish (value 1) or not (value 0) of updating outputs, see
+ * `quadiron_fnt32_encode`
+ * @param[in] block_size the block size in bytes
+ *
+ * @return 0 if update succeeded, else -1
+ */
+int quadiron_fnt32_update(
+    struct QuadironFnt32* fecp,
+    unsigned int data_idx,
+    const uint8_t* old_data,
+    const uint8_t* new_data,
+    uint8_t** data,
+    uint8_t** parity,
+    int* wanted_idxs,
+    size_t block_size);
+
 /** Decode blocks
  *
  * @note For non-systematic codes parities must be provided as data and parities
@@ -148,6 +261,57 @@ int quadiron_fnt32_reconstruct(
     unsigned int destination_idx,
     size_t block_size);
 
+/** Stages of the encoding and decoding timed by the statistics */
+enum QuadironStage {
+    QUADIRON_STAGE_PACK = 0,
+    QUADIRON_STAGE_UNPACK,
+    QUADIRON_STAGE_FFT,
+    QUADIRON_STAGE_HADAMARD,
+    QUADIRON_STAGE_POST_PROCESS,
+    QUADIRON_STAGE_PROPS,
+    QUADIRON_STAGE_CONTEXT_BUILD,
+    QUADIRON_STAGE_COPY,
+    QUADIRON_N_STAGES,
+};
+
+/** Statistics of one stage */
+struct QuadironStageStats {
+    /** Number of CPU cycles spent in the stage */
+    uint64_t cycles;
+    /** Number of times the stage was run */
+    uint64_t calls;
+};
+
+/** Enable or disable the per-stage statistics of the FEC
+ *
+ * Statistics are disabled by default. When enabled, each stage of the encoding
+ * and the decoding is timed, which slows them down a little.
+ *
+ * @param[in] fecp the FEC instance
+ * @param[in] enabled 1 to collect statistics, 0 to stop and discard them
+ */
+void quadiron_fnt32_enable_stats(struct QuadironFnt32* fecp, int enabled);
+
+/** Get the per-stage statistics collected since they were enabled or reset
+ *
+ * @param[in] fecp the FEC instance
+ * @param[out] stats array indexed by `enum QuadironStage`
+ * @param[in] n_stats length of stats, entries past `QUADIRON_N_STAGES` are
+ * left untouched
+ *
+ * @return 0 if succeeded, else -1 (statistics are disabled)
+ */
+int quadiron_fnt32_get_stats(
+    struct QuadironFnt32* fecp,
+    struct QuadironStageStats* stats,
+    size_t n_stats);
+
+/** Reset the per-stage statistics
+ *
+ * @param[in] fecp the FEC instance
+ */
+void quadiron_fnt32_reset_stats(struct QuadironFnt32* fecp);
+
 /** Dump a buffer on stderr (debug function)
  *
  * @param[in] buf the buffer
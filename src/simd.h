@@ -41,7 +41,7 @@ const unsigned F3 = 257;
 
 namespace quadiron {
 /** The namespace simd contains functions accelerated by
- *  using SIMD operations over 128bits and 256bits
+ *  using SIMD operations over 128bits, 256bits and 512bits
  *
  *  It supports operations on 16-bit and 32-bit numbers
  */
@@ -53,10 +53,24 @@ namespace simd {
 } // namespace quadiron
 
 // Include essential operations that use SIMD functions
-#if defined(__AVX2__)
+//
+// The backend TUs (`simd_backend_*.cpp`) pick their instruction set explicitly,
+// other TUs use the one they are compiled for.
+#if defined(QUADIRON_SIMD_BACKEND_AVX512)                                      \
+    || (!defined(QUADIRON_SIMD_BACKEND_AVX)                                    \
+        && !defined(QUADIRON_SIMD_BACKEND_SSE) && defined(__AVX512F__)         \
+        && defined(__AVX512BW__))
+#include "simd_512.h"
+#elif defined(QUADIRON_SIMD_BACKEND_AVX)                                       \
+    || (!defined(QUADIRON_SIMD_BACKEND_SSE) && defined(__AVX2__))
 #include "simd_256.h"
-#elif defined(__SSE4_1__)
+#elif defined(QUADIRON_SIMD_BACKEND_SSE) || defined(__SSE4_1__)
 #include "simd_128.h"
+#elif defined(QUADIRON_SIMD_BACKEND_NEON)                                      \
+    || (defined(__aarch64__) && defined(__ARM_NEON))
+#include "simd_neon.h"
+#else
+#error "simd.h requires SSE4.1, AVX2 or NEON, see simd_dispatch.h"
 #endif
 
 // Include accelerated operations dedicated for FNT
@@ -65,11 +79,16 @@ namespace simd {
 // Include accelerated operations dedicated for RingModN
 #include "simd_ring.h"
 
+// Include accelerated operations dedicated for binary extension fields
+#include "simd_gf2n.h"
+
 // Include accelerated operations dedicated for radix-2 FFT
 #include "simd_radix2_fft.h"
 
-// Include accelerated operations dedicated for NF4
+// Include accelerated operations dedicated for NF4 (only available on x86)
+#if defined(__i386__) || defined(__x86_64__)
 #include "simd_nf4.h"
+#endif
 
 #endif // #ifdef QUADIRON_USE_SIMD
 
@@ -62,23 +62,56 @@ namespace simd {
 
 /// Supported instruction set.
 enum class InstructionSet {
-    NONE, ///< No SIMD instruction (fallback).
-    SSE,  ///< SSE4.1
-    AVX,  ///< AVX2
+    NONE,   ///< No SIMD instruction (fallback).
+    SSE,    ///< SSE4.1
+    AVX,    ///< AVX2
+    AVX512, ///< AVX-512 (Foundation and Byte/Word)
+    NEON,   ///< ARM Advanced SIMD (AArch64)
 };
 
+// Definitions for Intel AVX-512 {{{
+
+// We require AVX512BW because we rely on instructions on 16-bit elements
+// (such as `_mm512_add_epi16`) that aren't available in AVX512F.
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+
+using RegisterType = __m512;
+using MaskType = __m512i;
+
+static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::AVX512;
+
+// }}}
 // Definitions for Intel AVX-256 {{{
 
 // We required AVX2 because we relies on some instructions (such as
 // `_mm256_add_epi16` and others) that aren't available in the first version of
 // AVX.
-#if defined(__AVX__) && defined(__AVX2__)
+#elif defined(__AVX__) && defined(__AVX2__)
 
 using RegisterType = __m256;
 using MaskType = __m256i;
 
 static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::AVX;
 
+// }}}
+// Definitions for runtime dispatch on x86 {{{
+
+// A dispatch build contains the AVX-512 kernels even if the compiler doesn't
+// target AVX-512: the memory layout must suit them, the kernels actually used
+// are selected at runtime (see `simd_dispatch.h`).
+//
+// Without AVX-512 enabled, `__m512` isn't 64-byte aligned, hence the explicit
+// layout.
+#elif defined(QUADIRON_SIMD_DISPATCH)                                          \
+    && (defined(__i386__) || defined(__x86_64__))
+
+struct alignas(64) RegisterType {
+    uint8_t bytes[64];
+};
+using MaskType = RegisterType;
+
+static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::AVX512;
+
 // }}}
 // Definitions for Intel SSE {{{
 
@@ -89,6 +122,18 @@ using MaskType = __m128i;
 
 static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::SSE;
 
+// }}}
+// Definitions for ARM NEON {{{
+
+// Only AArch64 is supported: some instructions (such as `vmaxvq_u32`) aren't
+// available on 32-bit ARM.
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+
+using RegisterType = uint32x4_t;
+using MaskType = uint32x4_t;
+
+static constexpr InstructionSet INSTRUCTION_SET = InstructionSet::NEON;
+
 // }}}
 // Definitions for scalar fallback {{{
 
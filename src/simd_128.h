@@ -33,8 +33,14 @@
 
 #include <x86intrin.h>
 
+/// Name of the namespace holding the kernels built for SSE4.1
+#define QUADIRON_SIMD_NS sse
+/// Width (in bits) of the registers used by the kernels
+#define QUADIRON_SIMD_BITSZ 128
+
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_NS {
 
 typedef __m128i VecType;
 
@@ -58,8 +64,10 @@ inline VecType zero()
     return _mm_setzero_si128();
 }
 
-// NOLINTNEXTLINE(cert-err58-cpp)
-const VecType MASK8_LO = _mm_set1_epi16(0x80);
+inline VecType mask8_lo()
+{
+    return _mm_set1_epi16(0x80);
+}
 
 /* ============= Essential Operations for SSE w/ both u16 & u32 ============ */
 
@@ -96,6 +104,19 @@ inline bool is_zero(const VecType& x)
 #define SHIFTR(x, imm8) (_mm_srli_si128(x, imm8))
 #define BLEND8(x, y, mask) (_mm_blendv_epi8(x, y, mask))
 #define BLEND16(x, y, imm8) (_mm_blend_epi16(x, y, imm8))
+#define SHIFTL16(x, imm8) (_mm_slli_epi16(x, imm8))
+#define SHIFTR16(x, imm8) (_mm_srli_epi16(x, imm8))
+
+/** Load a table of 16 bytes into each 128-bit lane of a register */
+inline VecType load_table16(const uint8_t* table)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+}
+/** Look up each byte of `idx` (less than 16) in the table of its lane */
+inline VecType shuffle8(const VecType& table, const VecType& idx)
+{
+    return _mm_shuffle_epi8(table, idx);
+}
 
 /* ================= Essential Operations for SSE ================= */
 
@@ -177,6 +198,7 @@ inline VecType min<uint16_t>(const VecType& x, const VecType& y)
     return _mm_min_epu16(x, y);
 }
 
+} // namespace QUADIRON_SIMD_NS
 } // namespace simd
 } // namespace quadiron
 
@@ -45,8 +45,14 @@ _mm256_storeu2_m128i(__m128i* const hi, __m128i* const lo, const __m256i a)
 
 #endif /* defined(__GNUC__) */
 
+/// Name of the namespace holding the kernels built for AVX2
+#define QUADIRON_SIMD_NS avx
+/// Width (in bits) of the registers used by the kernels
+#define QUADIRON_SIMD_BITSZ 256
+
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_NS {
 
 typedef __m256i VecType;
 typedef __m128i HalfVecType;
@@ -71,8 +77,10 @@ inline VecType zero()
     return _mm256_setzero_si256();
 }
 
-// NOLINTNEXTLINE(cert-err58-cpp)
-const VecType MASK8_LO = _mm256_set1_epi16(0x80);
+inline VecType mask8_lo()
+{
+    return _mm256_set1_epi16(0x80);
+}
 
 /* ============= Essential Operations for AVX2 w/ both u16 & u32 ============ */
 
@@ -109,6 +117,20 @@ inline bool is_zero(const VecType& x)
 #define SHIFTR(x, imm8) (_mm256_srli_si256(x, imm8))
 #define BLEND8(x, y, mask) (_mm256_blendv_epi8(x, y, mask))
 #define BLEND16(x, y, imm8) (_mm256_blend_epi16(x, y, imm8))
+#define SHIFTL16(x, imm8) (_mm256_slli_epi16(x, imm8))
+#define SHIFTR16(x, imm8) (_mm256_srli_epi16(x, imm8))
+
+/** Load a table of 16 bytes into each 128-bit lane of a register */
+inline VecType load_table16(const uint8_t* table)
+{
+    return _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+/** Look up each byte of `idx` (less than 16) in the table of its lane */
+inline VecType shuffle8(const VecType& table, const VecType& idx)
+{
+    return _mm256_shuffle_epi8(table, idx);
+}
 
 /* ================= Essential Operations for AVX2 ================= */
 
@@ -190,6 +212,7 @@ inline VecType min<uint16_t>(const VecType& x, const VecType& y)
     return _mm256_min_epu16(x, y);
 }
 
+} // namespace QUADIRON_SIMD_NS
 } // namespace simd
 } // namespace quadiron
 
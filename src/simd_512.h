@@ -0,0 +1,288 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __QUAD_SIMD_512_H__
+#define __QUAD_SIMD_512_H__
+
+#include <x86intrin.h>
+
+/// Name of the namespace holding the kernels built for AVX-512
+#define QUADIRON_SIMD_NS avx512
+/// Width (in bits) of the registers used by the kernels
+#define QUADIRON_SIMD_BITSZ 512
+
+/* GCC 12 wrongly warns about the undefined registers used by the AVX-512
+ * intrinsics (GCC bug 105593), silence it for the wrappers below. */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif /* defined(__GNUC__) */
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_NS {
+
+typedef __m512i VecType;
+typedef __m256i HalfVecType;
+
+/* ============= Constant variable  ============ */
+
+template <typename T>
+inline VecType one();
+template <>
+inline VecType one<uint16_t>()
+{
+    return _mm512_set1_epi16(1);
+}
+template <>
+inline VecType one<uint32_t>()
+{
+    return _mm512_set1_epi32(1);
+}
+
+inline VecType zero()
+{
+    return _mm512_setzero_si512();
+}
+
+inline VecType mask8_lo()
+{
+    return _mm512_set1_epi16(0x80);
+}
+
+/* ========== Essential Operations for AVX-512 w/ both u16 & u32 ========== */
+
+inline VecType load_to_reg(VecType* address)
+{
+    return _mm512_load_si512(address);
+}
+inline void store_to_mem(VecType* address, const VecType& reg)
+{
+    _mm512_store_si512(address, reg);
+}
+
+inline VecType bit_and(const VecType& x, const VecType& y)
+{
+    return _mm512_and_si512(x, y);
+}
+inline VecType bit_xor(const VecType& x, const VecType& y)
+{
+    return _mm512_xor_si512(x, y);
+}
+inline __m128i low_128(const VecType& x)
+{
+    return _mm512_castsi512_si128(x);
+}
+inline uint64_t msb8_mask(const VecType& x)
+{
+    return _mm512_movepi8_mask(x);
+}
+inline bool and_is_zero(const VecType& x, const VecType& y)
+{
+    return _mm512_test_epi64_mask(x, y) == 0;
+}
+inline bool is_zero(const VecType& x)
+{
+    return _mm512_test_epi64_mask(x, x) == 0;
+}
+
+// Same semantic as their AVX2 counterparts: shifts within 128-bit lanes, the
+// 8-bit blend uses the MSB of each byte of `mask` and the 16-bit blend repeats
+// `imm8` for each group of 8 elements.
+#define SHIFTR(x, imm8) (_mm512_bsrli_epi128(x, imm8))
+#define BLEND8(x, y, mask)                                                     \
+    (_mm512_mask_blend_epi8(_mm512_movepi8_mask(mask), x, y))
+#define BLEND16(x, y, imm8)                                                    \
+    (_mm512_mask_blend_epi16((imm8)*0x01010101U, x, y))
+#define SHIFTL16(x, imm8) (_mm512_slli_epi16(x, imm8))
+#define SHIFTR16(x, imm8) (_mm512_srli_epi16(x, imm8))
+
+/** Load a table of 16 bytes into each 128-bit lane of a register */
+inline VecType load_table16(const uint8_t* table)
+{
+    return _mm512_broadcast_i32x4(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+/** Look up each byte of `idx` (less than 16) in the table of its lane */
+inline VecType shuffle8(const VecType& table, const VecType& idx)
+{
+    return _mm512_shuffle_epi8(table, idx);
+}
+
+/* ================= Essential Operations for AVX-512 ================= */
+
+template <typename T>
+inline VecType set_one(T val);
+template <>
+inline VecType set_one(uint32_t val)
+{
+    return _mm512_set1_epi32(val);
+}
+template <>
+inline VecType set_one(uint16_t val)
+{
+    return _mm512_set1_epi16(val);
+}
+
+template <typename T>
+inline VecType add(const VecType& x, const VecType& y);
+template <>
+inline VecType add<uint32_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_add_epi32(x, y);
+}
+template <>
+inline VecType add<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_add_epi16(x, y);
+}
+
+template <typename T>
+inline VecType sub(const VecType& x, const VecType& y);
+template <>
+inline VecType sub<uint32_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_sub_epi32(x, y);
+}
+template <>
+inline VecType sub<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_sub_epi16(x, y);
+}
+
+template <typename T>
+inline VecType mul(const VecType& x, const VecType& y);
+template <>
+inline VecType mul<uint32_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_mullo_epi32(x, y);
+}
+template <>
+inline VecType mul<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_mullo_epi16(x, y);
+}
+
+template <typename T>
+inline VecType compare_eq(const VecType& x, const VecType& y);
+template <>
+inline VecType compare_eq<uint32_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_maskz_mov_epi32(
+        _mm512_cmpeq_epi32_mask(x, y), _mm512_set1_epi32(-1));
+}
+template <>
+inline VecType compare_eq<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_movm_epi16(_mm512_cmpeq_epi16_mask(x, y));
+}
+
+template <typename T>
+inline VecType min(const VecType& x, const VecType& y);
+template <>
+inline VecType min<uint32_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_min_epu32(x, y);
+}
+template <>
+inline VecType min<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_min_epu16(x, y);
+}
+
+/* ================= Mask registers operations ================= */
+
+/** Return a mask with one bit per element, set if `x & y` isn't null. */
+template <typename T>
+inline uint32_t and_nonzero_mask(const VecType& x, const VecType& y);
+template <>
+inline uint32_t and_nonzero_mask<uint32_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_test_epi32_mask(x, y);
+}
+template <>
+inline uint32_t and_nonzero_mask<uint16_t>(const VecType& x, const VecType& y)
+{
+    return _mm512_test_epi16_mask(x, y);
+}
+
+/** Return a mask selecting the `n` first elements of a register.
+ *
+ * @note `n` must be less than the number of elements in a register.
+ */
+inline uint32_t first_elements_mask(size_t n)
+{
+    return (1U << n) - 1;
+}
+
+/** Load the `n` first elements of a register from an unaligned address, the
+ * other ones are set to zero.
+ */
+template <typename T>
+inline VecType load_first(const T* address, size_t n);
+template <>
+inline VecType load_first<uint32_t>(const uint32_t* address, size_t n)
+{
+    return _mm512_maskz_loadu_epi32(
+        static_cast<__mmask16>(first_elements_mask(n)), address);
+}
+template <>
+inline VecType load_first<uint16_t>(const uint16_t* address, size_t n)
+{
+    return _mm512_maskz_loadu_epi16(first_elements_mask(n), address);
+}
+
+/** Store the `n` first elements of a register to an unaligned address. */
+template <typename T>
+inline void store_first(T* address, const VecType& reg, size_t n);
+template <>
+inline void
+store_first<uint32_t>(uint32_t* address, const VecType& reg, size_t n)
+{
+    _mm512_mask_storeu_epi32(
+        address, static_cast<__mmask16>(first_elements_mask(n)), reg);
+}
+template <>
+inline void
+store_first<uint16_t>(uint16_t* address, const VecType& reg, size_t n)
+{
+    _mm512_mask_storeu_epi16(address, first_elements_mask(n), reg);
+}
+
+} // namespace QUADIRON_SIMD_NS
+} // namespace simd
+} // namespace quadiron
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* defined(__GNUC__) */
+
+#endif
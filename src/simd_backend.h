@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __QUAD_SIMD_BACKEND_H__
+#define __QUAD_SIMD_BACKEND_H__
+
+#include "simd.h"
+#include "simd_dispatch.h"
+
+/** @file simd_backend.h
+ *
+ * Build the kernel table of the instruction set selected by `simd.h`.
+ *
+ * This header is only meant to be included by the `simd_backend_*.cpp` files,
+ * each one of them building the kernels for a given instruction set.
+ */
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_NS {
+
+template <typename T>
+constexpr FntKernels<T> make_fnt_kernels()
+{
+    return {
+        sizeof(VecType) / sizeof(T),
+        &butterfly_ct_two_layers_step<T>,
+        &butterfly_ct_step<T>,
+        &butterfly_gs_step<T>,
+        &butterfly_gs_step_simple<T>,
+        &butterfly_gs_two_layers_step<T>,
+        &encode_post_process<T>,
+        &mul_coef_to_buf<T>,
+        &add_two_bufs<T>,
+        &sub_two_bufs<T>,
+        &mul_two_bufs<T>,
+        &neg<T>,
+    };
+}
+
+template <typename T>
+constexpr Gf2nKernels<T> make_gf2n_kernels()
+{
+    return {
+        &gf2n_mul_coef_to_buf<T>,
+        &gf2n_mul_coef_add_to_buf<T>,
+        &gf2n_add_two_bufs<T>,
+    };
+}
+
+constexpr Nf4Kernels make_nf4_kernels()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return {
+        &expand16,
+        &expand32,
+        &add,
+        &sub,
+        &mul,
+        &hadamard_mul,
+        &unpack,
+        &unpack,
+        &pack,
+        &pack,
+    };
+#else
+    // No NF4 kernels: the field uses its scalar implementation.
+    return {};
+#endif
+}
+
+constexpr Kernels make_kernels(InstructionSet instruction_set)
+{
+    return {
+        instruction_set,
+        make_fnt_kernels<uint16_t>(),
+        make_fnt_kernels<uint32_t>(),
+        make_gf2n_kernels<uint16_t>(),
+        make_gf2n_kernels<uint32_t>(),
+        make_nf4_kernels(),
+    };
+}
+
+} // namespace QUADIRON_SIMD_NS
+} // namespace simd
+} // namespace quadiron
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * The file builds the SIMD kernels for AVX-512, see simd_dispatch.h
+ */
+
+#include "arith.h"
+#include "simd_dispatch.h"
+
+#if defined(QUADIRON_USE_SIMD)                                                 \
+    && ((defined(QUADIRON_SIMD_DISPATCH)                                       \
+         && (defined(__i386__) || defined(__x86_64__)))                        \
+        || (defined(__AVX512F__) && defined(__AVX512BW__)))
+
+#define QUADIRON_SIMD_BACKEND_AVX512
+
+// In a dispatch build, only the kernels are compiled for AVX-512: everything
+// included above keeps the baseline instruction set.
+#ifdef QUADIRON_SIMD_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute push(                                                  \
+    __attribute__((target("avx512f,avx512bw"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw")
+#endif
+#endif // #ifdef QUADIRON_SIMD_DISPATCH
+
+#include "simd_backend.h"
+
+#ifdef QUADIRON_SIMD_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // #ifdef QUADIRON_SIMD_DISPATCH
+
+namespace quadiron {
+namespace simd {
+
+namespace {
+
+// Constant-initialized: no AVX-512 instruction runs before the CPU is checked.
+constexpr Kernels kernels = avx512::make_kernels(InstructionSet::AVX512);
+
+} // namespace
+
+const Kernels* get_avx512_kernels()
+{
+    return &kernels;
+}
+
+} // namespace simd
+} // namespace quadiron
+
+#else
+
+namespace quadiron {
+namespace simd {
+
+const Kernels* get_avx512_kernels()
+{
+    return nullptr;
+}
+
+} // namespace simd
+} // namespace quadiron
+
+#endif
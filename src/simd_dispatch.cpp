@@ -0,0 +1,189 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "exceptions.h"
+#include "simd_dispatch.h"
+
+namespace quadiron {
+namespace simd {
+
+namespace {
+
+const Kernels* kernels_of(InstructionSet instruction_set)
+{
+    switch (instruction_set) {
+    case InstructionSet::NONE:
+        return nullptr;
+    case InstructionSet::SSE:
+        return get_sse_kernels();
+    case InstructionSet::AVX:
+        return get_avx_kernels();
+    case InstructionSet::AVX512:
+        return get_avx512_kernels();
+    case InstructionSet::NEON:
+        return get_neon_kernels();
+    }
+    return nullptr;
+}
+
+bool cpu_supports(InstructionSet instruction_set)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_cpu_init();
+    switch (instruction_set) {
+    case InstructionSet::NONE:
+        return true;
+    case InstructionSet::SSE:
+        return __builtin_cpu_supports("sse4.1") != 0;
+    case InstructionSet::AVX:
+        return __builtin_cpu_supports("avx2") != 0;
+    case InstructionSet::AVX512:
+        return __builtin_cpu_supports("avx512f") != 0
+               && __builtin_cpu_supports("avx512bw") != 0;
+    case InstructionSet::NEON:
+        return false;
+    }
+    return false;
+#elif defined(__aarch64__)
+    // Advanced SIMD is part of the AArch64 baseline.
+    return instruction_set == InstructionSet::NONE
+           || instruction_set == InstructionSet::NEON;
+#else
+    return instruction_set == InstructionSet::NONE;
+#endif
+}
+
+/** Return the instruction set to use by default: the one requested by the
+ * `QUADIRON_SIMD` environment variable if it is supported, the best one
+ * otherwise.
+ */
+InstructionSet default_instruction_set()
+{
+    const char* requested = std::getenv("QUADIRON_SIMD");
+
+    if (requested != nullptr) {
+        for (InstructionSet instruction_set : {InstructionSet::NONE,
+                                               InstructionSet::SSE,
+                                               InstructionSet::AVX,
+                                               InstructionSet::AVX512,
+                                               InstructionSet::NEON}) {
+            if (std::strcmp(
+                    requested, get_instruction_set_name(instruction_set))
+                    == 0
+                && is_supported(instruction_set)) {
+                return instruction_set;
+            }
+        }
+    }
+    return detect_instruction_set();
+}
+
+std::atomic<const Kernels*>& current_kernels()
+{
+    static std::atomic<const Kernels*> kernels(
+        kernels_of(default_instruction_set()));
+    return kernels;
+}
+
+} // namespace
+
+const char* get_instruction_set_name(InstructionSet instruction_set)
+{
+    switch (instruction_set) {
+    case InstructionSet::NONE:
+        return "none";
+    case InstructionSet::SSE:
+        return "sse";
+    case InstructionSet::AVX:
+        return "avx";
+    case InstructionSet::AVX512:
+        return "avx512";
+    case InstructionSet::NEON:
+        return "neon";
+    }
+    return "unknown";
+}
+
+bool is_supported(InstructionSet instruction_set)
+{
+    if (instruction_set == InstructionSet::NONE) {
+        return true;
+    }
+    return kernels_of(instruction_set) != nullptr
+           && cpu_supports(instruction_set);
+}
+
+InstructionSet detect_instruction_set()
+{
+    if (is_supported(InstructionSet::AVX512)) {
+        return InstructionSet::AVX512;
+    }
+    if (is_supported(InstructionSet::AVX)) {
+        return InstructionSet::AVX;
+    }
+    if (is_supported(InstructionSet::SSE)) {
+        return InstructionSet::SSE;
+    }
+    if (is_supported(InstructionSet::NEON)) {
+        return InstructionSet::NEON;
+    }
+    return InstructionSet::NONE;
+}
+
+InstructionSet get_instruction_set()
+{
+    const Kernels* kernels = get_kernels();
+    return kernels == nullptr ? InstructionSet::NONE
+                              : kernels->instruction_set;
+}
+
+void set_instruction_set(InstructionSet instruction_set)
+{
+    if (!is_supported(instruction_set)) {
+        throw InvalidArgument(
+            std::string("unsupported instruction set: ")
+            + get_instruction_set_name(instruction_set));
+    }
+    current_kernels().store(kernels_of(instruction_set));
+}
+
+const Kernels* get_kernels()
+{
+    return current_kernels().load(std::memory_order_acquire);
+}
+
+} // namespace simd
+} // namespace quadiron
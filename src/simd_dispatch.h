@@ -0,0 +1,274 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __QUAD_SIMD_DISPATCH_H__
+#define __QUAD_SIMD_DISPATCH_H__
+
+#include <cstdint>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "core.h"
+#include "property.h"
+#include "simd/definitions.h"
+#include "vec_buffers.h"
+
+/** @file simd_dispatch.h
+ *
+ * Runtime selection of the SIMD kernels.
+ *
+ * The kernels of `simd_fnt.h`, `simd_ring.h`, `simd_gf2n.h`,
+ * `simd_radix2_fft.h` and `simd_nf4.h` are built once per instruction set
+ * supported by the build (see `simd_backend.h`) and exposed as tables of
+ * function pointers.
+ *
+ * The best table supported by the CPU is selected on first use. The choice can
+ * be forced with the `QUADIRON_SIMD` environment variable (`none`, `sse`,
+ * `avx`, `avx512` or `neon`) or with `set_instruction_set`. When no table is selected,
+ * the callers use their scalar implementation.
+ */
+
+namespace quadiron {
+namespace simd {
+
+/** Kernels working on buffers of `T` (see `simd_radix2_fft.h` and
+ * `simd_ring.h` for the description of each kernel).
+ */
+template <typename T>
+struct FntKernels {
+    /// Number of elements of type `T` held by a register.
+    unsigned countof;
+
+    void (*butterfly_ct_two_layers_step)(
+        vec::Buffers<T>& buf,
+        T r1,
+        T r2,
+        T r3,
+        unsigned start,
+        unsigned m,
+        size_t len,
+        T card);
+    void (*butterfly_ct_step)(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        unsigned step,
+        size_t len,
+        T card);
+    void (*butterfly_gs_step)(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        size_t len,
+        T card);
+    void (*butterfly_gs_step_simple)(
+        vec::Buffers<T>& buf,
+        T r,
+        unsigned start,
+        unsigned m,
+        size_t len,
+        T card);
+    void (*butterfly_gs_two_layers_step)(
+        vec::Buffers<T>& buf,
+        T r1,
+        T r2,
+        T r3,
+        unsigned start,
+        unsigned m,
+        size_t len,
+        T card);
+    void (*encode_post_process)(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        unsigned code_len,
+        T threshold,
+        size_t vecs_nb);
+
+    void (*mul_coef_to_buf)(T a, T* src, T* dest, size_t len, T card);
+    void (*add_two_bufs)(T* src, T* dest, size_t len, T card);
+    void (*sub_two_bufs)(T* bufa, T* bufb, T* res, size_t len, T card);
+    void (*mul_two_bufs)(T* src, T* dest, size_t len, T card);
+    void (*neg)(size_t len, T* buf, T card);
+};
+
+/** Kernels of the binary extension fields GF(2^8) and GF(2^16) working on
+ * buffers of `T` (see `simd_gf2n.h`).
+ */
+template <typename T>
+struct Gf2nKernels {
+    void (*mul_coef_to_buf)(
+        const uint8_t* tables,
+        unsigned n,
+        T* src,
+        T* dest,
+        size_t len);
+    void (*mul_coef_add_to_buf)(
+        const uint8_t* tables,
+        unsigned n,
+        T* src,
+        T* dest,
+        size_t len);
+    void (*add_two_bufs)(T* bufa, T* bufb, T* res, size_t len);
+};
+
+/** Kernels of the NF4 field (see `simd_nf4.h`).
+ *
+ * Instruction sets without NF4 kernels leave every pointer to `nullptr`.
+ */
+struct Nf4Kernels {
+    __uint128_t (*expand16)(uint16_t* arr, int n);
+    __uint128_t (*expand32)(uint32_t* arr, int n);
+    __uint128_t (*add)(__uint128_t a, __uint128_t b);
+    __uint128_t (*sub)(__uint128_t a, __uint128_t b);
+    __uint128_t (*mul)(__uint128_t a, __uint128_t b);
+    void (*hadamard_mul)(unsigned n, __uint128_t* x, __uint128_t* y);
+    GroupedValues<__uint128_t> (*unpack)(__uint128_t a);
+    void (*unpack_to)(__uint128_t a, GroupedValues<__uint128_t>& b);
+    __uint128_t (*pack)(__uint128_t a);
+    __uint128_t (*pack_flagged)(__uint128_t a, uint32_t flag);
+};
+
+/** All the kernels built for a given instruction set. */
+struct Kernels {
+    InstructionSet instruction_set;
+    FntKernels<uint16_t> fnt16;
+    FntKernels<uint32_t> fnt32;
+    Gf2nKernels<uint16_t> gf2n16;
+    Gf2nKernels<uint32_t> gf2n32;
+    Nf4Kernels nf4;
+};
+
+/** Return the kernels built for SSE4.1, `nullptr` if not part of the build. */
+const Kernels* get_sse_kernels();
+
+/** Return the kernels built for AVX2, `nullptr` if not part of the build. */
+const Kernels* get_avx_kernels();
+
+/** Return the kernels built for AVX-512, `nullptr` if not part of the build. */
+const Kernels* get_avx512_kernels();
+
+/** Return the kernels built for NEON, `nullptr` if not part of the build. */
+const Kernels* get_neon_kernels();
+
+/** Return the name of an instruction set ("none", "sse", "avx", "avx512" or
+ * "neon").
+ */
+const char* get_instruction_set_name(InstructionSet instruction_set);
+
+/** Check if an instruction set is both built in and supported by the CPU.
+ *
+ * @note `InstructionSet::NONE` is always supported
+ */
+bool is_supported(InstructionSet instruction_set);
+
+/** Return the best instruction set supported by the build and the CPU. */
+InstructionSet detect_instruction_set();
+
+/** Return the instruction set of the kernels currently in use. */
+InstructionSet get_instruction_set();
+
+/** Select the kernels to use.
+ *
+ * FFTs and codes pick their kernels when they are created: the existing ones
+ * keep using the previous kernels.
+ *
+ * @throw InvalidArgument if `instruction_set` is not supported
+ */
+void set_instruction_set(InstructionSet instruction_set);
+
+/** Return the kernels currently in use, `nullptr` for the scalar fallback. */
+const Kernels* get_kernels();
+
+/** Return the kernels over `T` currently in use, `nullptr` if there are none
+ * (scalar fallback or no kernel for this type).
+ */
+template <typename T>
+inline const FntKernels<T>* get_fnt_kernels()
+{
+    return nullptr;
+}
+
+template <>
+inline const FntKernels<uint16_t>* get_fnt_kernels<uint16_t>()
+{
+    const Kernels* kernels = get_kernels();
+    return kernels == nullptr ? nullptr : &kernels->fnt16;
+}
+
+template <>
+inline const FntKernels<uint32_t>* get_fnt_kernels<uint32_t>()
+{
+    const Kernels* kernels = get_kernels();
+    return kernels == nullptr ? nullptr : &kernels->fnt32;
+}
+
+/** Return the GF(2^n) kernels over `T` currently in use, `nullptr` if there
+ * are none (scalar fallback or no kernel for this type).
+ */
+template <typename T>
+inline const Gf2nKernels<T>* get_gf2n_kernels()
+{
+    return nullptr;
+}
+
+template <>
+inline const Gf2nKernels<uint16_t>* get_gf2n_kernels<uint16_t>()
+{
+    const Kernels* kernels = get_kernels();
+    return kernels == nullptr ? nullptr : &kernels->gf2n16;
+}
+
+template <>
+inline const Gf2nKernels<uint32_t>* get_gf2n_kernels<uint32_t>()
+{
+    const Kernels* kernels = get_kernels();
+    return kernels == nullptr ? nullptr : &kernels->gf2n32;
+}
+
+/** Return the NF4 kernels currently in use, `nullptr` for the scalar
+ * fallback.
+ */
+inline const Nf4Kernels* get_nf4_kernels()
+{
+    const Kernels* kernels = get_kernels();
+    if (kernels == nullptr || kernels->nf4.add == nullptr) {
+        return nullptr;
+    }
+    return &kernels->nf4;
+}
+
+} // namespace simd
+} // namespace quadiron
+
+#endif
@@ -31,10 +31,9 @@
 #ifndef __QUAD_SIMD_FNT_H__
 #define __QUAD_SIMD_FNT_H__
 
-#include <x86intrin.h>
-
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_NS {
 
 template <typename T>
 inline VecType card();
@@ -69,7 +68,7 @@ inline VecType get_low_half(const VecType& x);
 template <>
 inline VecType get_low_half<uint16_t>(const VecType& x)
 {
-    return BLEND8(zero(), x, MASK8_LO);
+    return BLEND8(zero(), x, mask8_lo());
 }
 template <>
 inline VecType get_low_half<uint32_t>(const VecType& x)
@@ -82,7 +81,7 @@ inline VecType get_high_half(const VecType& x);
 template <>
 inline VecType get_high_half<uint16_t>(const VecType& x)
 {
-    return BLEND8(zero(), SHIFTR(x, 1), MASK8_LO);
+    return BLEND8(zero(), SHIFTR(x, 1), mask8_lo());
 }
 template <>
 inline VecType get_high_half<uint32_t>(const VecType& x)
@@ -196,6 +195,15 @@ inline void add_props(
     T)
 {
     const VecType b = compare_eq<T>(threshold, symb);
+#if QUADIRON_SIMD_BITSZ == 512
+    // Mask registers directly provide one bit per element.
+    uint32_t d = and_nonzero_mask<T>(mask, b);
+    while (d > 0) {
+        const unsigned element_idx = __builtin_ctz(d);
+        props.add(offset + element_idx, OOR_MARK);
+        d &= d - 1;
+    }
+#else
     const VecType c = bit_and(mask, b);
     auto d = msb8_mask(c);
     const unsigned element_size = sizeof(T);
@@ -205,8 +213,10 @@ inline void add_props(
         props.add(_offset, OOR_MARK);
         d ^= 1 << byte_idx;
     }
+#endif
 }
 
+} // namespace QUADIRON_SIMD_NS
 } // namespace simd
 } // namespace quadiron
 
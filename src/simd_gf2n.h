@@ -0,0 +1,232 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __QUAD_SIMD_GF2N_H__
+#define __QUAD_SIMD_GF2N_H__
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_NS {
+
+/* ============== Operations for binary extension fields ============== */
+
+/*
+ * Multiplications by a coefficient `a` of GF(2^n), n = 8 or 16, use 4-bit
+ * split tables: the product is the XOR of the products of `a` by each nibble
+ * of the operand, looked up with byte shuffles.
+ *
+ * The caller provides (n / 4) * (n / 8) tables of 16 bytes: the table of
+ * index `i * (n / 8) + b` stores the byte `b` of `a * (v << (4 * i))` for
+ * `v` in [0, 16).
+ *
+ * Elements are stored in the low bytes of their 16-bit or 32-bit lanes and
+ * the other bytes are null, hence looked up as null products.
+ */
+
+/** Multiply an element by the coefficient described by `tables` */
+template <typename T>
+inline T gf2n_mul_by_tables(const uint8_t* tables, unsigned n, T x)
+{
+    const unsigned bytes_nb = n / 8;
+    T res = 0;
+    for (unsigned i = 0; i < n / 4; ++i) {
+        const unsigned v = (x >> (4 * i)) & 0xf;
+        for (unsigned b = 0; b < bytes_nb; ++b) {
+            res ^= T(tables[(i * bytes_nb + b) * 16 + v]) << (8 * b);
+        }
+    }
+    return res;
+}
+
+/** Multiply the elements of GF(2^8) of a register
+ *
+ * @param t the 2 tables of the coefficient
+ * @param mask a register storing 0x0f in each byte
+ * @param x input register
+ */
+inline VecType gf2n_mul8(const VecType* t, const VecType& mask, VecType x)
+{
+    const VecType lo = bit_and(x, mask);
+    const VecType hi = bit_and(SHIFTR16(x, 4), mask);
+    return bit_xor(shuffle8(t[0], lo), shuffle8(t[1], hi));
+}
+
+/** Multiply the elements of GF(2^16) of a register
+ *
+ * The nibbles of the low (resp. high) byte of each 16-bit word are looked up
+ * at the position of that byte, the partial products are then moved to the
+ * byte they belong to.
+ *
+ * @param t the 8 tables of the coefficient
+ * @param mask a register storing 0x0f in each byte
+ * @param mask_lo a register storing 0x00ff in each 16-bit word
+ * @param x input register
+ */
+inline VecType gf2n_mul16(
+    const VecType* t,
+    const VecType& mask,
+    const VecType& mask_lo,
+    VecType x)
+{
+    const VecType lo = bit_and(x, mask);
+    const VecType hi = bit_and(SHIFTR16(x, 4), mask);
+
+    // byte `b` of the product of the low byte, valid in the low byte
+    const VecType lo_0 = bit_xor(shuffle8(t[0], lo), shuffle8(t[2], hi));
+    const VecType lo_1 = bit_xor(shuffle8(t[1], lo), shuffle8(t[3], hi));
+    // byte `b` of the product of the high byte, valid in the high byte
+    const VecType hi_0 = bit_xor(shuffle8(t[4], lo), shuffle8(t[6], hi));
+    const VecType hi_1 = bit_xor(shuffle8(t[5], lo), shuffle8(t[7], hi));
+
+    const VecType res_lo = bit_xor(lo_0, SHIFTR16(hi_0, 8));
+    const VecType res_hi = bit_xor(hi_1, SHIFTL16(lo_1, 8));
+    // low byte from `res_lo`, high byte from `res_hi`
+    return bit_xor(res_hi, bit_and(bit_xor(res_lo, res_hi), mask_lo));
+}
+
+/** Multiply each element of `src` by the coefficient described by `tables`
+ *
+ * @tparam accumulate whether the products are added to `dest` or stored to it
+ * @param tables the split tables of the coefficient (see above)
+ * @param n degree of the field, 8 or 16
+ */
+template <bool accumulate, typename T>
+inline void do_gf2n_mul_coef_to_buf(
+    const uint8_t* tables,
+    unsigned n,
+    T* src,
+    T* dest,
+    size_t len)
+{
+    VecType t[8];
+    for (unsigned i = 0; i < (n / 4) * (n / 8); ++i) {
+        t[i] = load_table16(tables + 16 * i);
+    }
+    const VecType mask = set_one<uint16_t>(0x0f0f);
+    const VecType mask_lo = set_one<uint16_t>(0x00ff);
+
+    VecType* _src = reinterpret_cast<VecType*>(src);
+    VecType* _dest = reinterpret_cast<VecType*>(dest);
+    const unsigned ratio = sizeof(*_src) / sizeof(*src);
+    const size_t _len = len / ratio;
+
+    size_t i;
+    if (n == 8) {
+        for (i = 0; i < _len; ++i) {
+            const VecType y = gf2n_mul8(t, mask, _src[i]);
+            _dest[i] = accumulate ? bit_xor(_dest[i], y) : y;
+        }
+    } else {
+        for (i = 0; i < _len; ++i) {
+            const VecType y = gf2n_mul16(t, mask, mask_lo, _src[i]);
+            _dest[i] = accumulate ? bit_xor(_dest[i], y) : y;
+        }
+    }
+
+#if QUADIRON_SIMD_BITSZ == 512
+    const size_t _last_len = len - _len * ratio;
+    if (_last_len > 0) {
+        const size_t offset = _len * ratio;
+        const VecType x = load_first(src + offset, _last_len);
+        VecType y = n == 8 ? gf2n_mul8(t, mask, x)
+                           : gf2n_mul16(t, mask, mask_lo, x);
+        if (accumulate) {
+            y = bit_xor(y, load_first(dest + offset, _last_len));
+        }
+        store_first(dest + offset, y, _last_len);
+    }
+#else
+    for (i = _len * ratio; i < len; i++) {
+        const T y = gf2n_mul_by_tables(tables, n, src[i]);
+        dest[i] = accumulate ? (dest[i] ^ y) : y;
+    }
+#endif
+}
+
+/** Perform a multiplication of a coefficient `a` of GF(2^n) to each element of
+ *  `src` and store the result to the correspondent element of `dest`
+ *
+ * @param tables the split tables of `a` (see above)
+ * @param n degree of the field, 8 or 16
+ */
+template <typename T>
+inline void gf2n_mul_coef_to_buf(
+    const uint8_t* tables,
+    unsigned n,
+    T* src,
+    T* dest,
+    size_t len)
+{
+    do_gf2n_mul_coef_to_buf<false>(tables, n, src, dest, len);
+}
+
+/** Perform a multiplication of a coefficient `a` of GF(2^n) to each element of
+ *  `src` and add, i.e. XOR, the result to the correspondent element of `dest`
+ *
+ * @param tables the split tables of `a` (see above)
+ * @param n degree of the field, 8 or 16
+ */
+template <typename T>
+inline void gf2n_mul_coef_add_to_buf(
+    const uint8_t* tables,
+    unsigned n,
+    T* src,
+    T* dest,
+    size_t len)
+{
+    do_gf2n_mul_coef_to_buf<true>(tables, n, src, dest, len);
+}
+
+/** Add, i.e. XOR, each element of `bufa` to the correspondent element of
+ *  `bufb` and store the result to `res`
+ */
+template <typename T>
+inline void gf2n_add_two_bufs(T* bufa, T* bufb, T* res, size_t len)
+{
+    VecType* _bufa = reinterpret_cast<VecType*>(bufa);
+    VecType* _bufb = reinterpret_cast<VecType*>(bufb);
+    VecType* _res = reinterpret_cast<VecType*>(res);
+    const unsigned ratio = sizeof(*_bufa) / sizeof(*bufa);
+    const size_t _len = len / ratio;
+
+    size_t i;
+    for (i = 0; i < _len; i++) {
+        _res[i] = bit_xor(_bufa[i], _bufb[i]);
+    }
+    for (i = _len * ratio; i < len; i++) {
+        res[i] = bufa[i] ^ bufb[i];
+    }
+}
+
+} // namespace QUADIRON_SIMD_NS
+} // namespace simd
+} // namespace quadiron
+
+#endif
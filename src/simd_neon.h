@@ -0,0 +1,244 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __QUAD_SIMD_NEON_H__
+#define __QUAD_SIMD_NEON_H__
+
+#include <arm_neon.h>
+
+/// Name of the namespace holding the kernels built for ARM NEON
+#define QUADIRON_SIMD_NS neon
+/// Width (in bits) of the registers used by the kernels
+#define QUADIRON_SIMD_BITSZ 128
+
+namespace quadiron {
+namespace simd {
+inline namespace QUADIRON_SIMD_NS {
+
+// NEON registers are typed by their elements: the kernels work on registers of
+// 32-bit elements and reinterpret them for the operations on 16-bit ones.
+typedef uint32x4_t VecType;
+
+/* ============= Constant variable  ============ */
+
+template <typename T>
+inline VecType one();
+template <>
+inline VecType one<uint16_t>()
+{
+    return vreinterpretq_u32_u16(vdupq_n_u16(1));
+}
+template <>
+inline VecType one<uint32_t>()
+{
+    return vdupq_n_u32(1);
+}
+
+inline VecType zero()
+{
+    return vdupq_n_u32(0);
+}
+
+inline VecType mask8_lo()
+{
+    return vreinterpretq_u32_u16(vdupq_n_u16(0x80));
+}
+
+/* ============= Essential Operations for NEON w/ both u16 & u32 ============ */
+
+inline VecType load_to_reg(VecType* address)
+{
+    return vld1q_u32(reinterpret_cast<const uint32_t*>(address));
+}
+inline void store_to_mem(VecType* address, const VecType& reg)
+{
+    vst1q_u32(reinterpret_cast<uint32_t*>(address), reg);
+}
+
+inline VecType bit_and(const VecType& x, const VecType& y)
+{
+    return vandq_u32(x, y);
+}
+inline VecType bit_xor(const VecType& x, const VecType& y)
+{
+    return veorq_u32(x, y);
+}
+/** Gather the MSB of each byte, as `_mm_movemask_epi8` does. */
+inline uint32_t msb8_mask(const VecType& x)
+{
+    const int8x16_t shifts = {0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7};
+    const uint8x16_t msb = vshrq_n_u8(vreinterpretq_u8_u32(x), 7);
+    const uint8x16_t bits = vshlq_u8(msb, shifts);
+    const uint32_t lo = vaddv_u8(vget_low_u8(bits));
+    const uint32_t hi = vaddv_u8(vget_high_u8(bits));
+    return lo | (hi << 8);
+}
+inline bool and_is_zero(const VecType& x, const VecType& y)
+{
+    return vmaxvq_u32(vandq_u32(x, y)) == 0;
+}
+inline bool is_zero(const VecType& x)
+{
+    return vmaxvq_u32(x) == 0;
+}
+
+/** Select the bytes of `y` where the MSB of `mask` is set, those of `x`
+ * otherwise (as `_mm_blendv_epi8` does).
+ */
+inline VecType blend8(const VecType& x, const VecType& y, const VecType& mask)
+{
+    const uint8x16_t select = vcltzq_s8(vreinterpretq_s8_u32(mask));
+    return vreinterpretq_u32_u8(vbslq_u8(
+        select, vreinterpretq_u8_u32(y), vreinterpretq_u8_u32(x)));
+}
+
+/** Select the 16-bit elements of `y` where the corresponding bit of `imm8` is
+ * set, those of `x` otherwise (as `_mm_blend_epi16` does).
+ */
+inline VecType blend16(const VecType& x, const VecType& y, uint16_t imm8)
+{
+    const uint16x8_t bits = {1, 2, 4, 8, 16, 32, 64, 128};
+    const uint16x8_t select = vtstq_u16(vdupq_n_u16(imm8), bits);
+    return vreinterpretq_u32_u16(vbslq_u16(
+        select, vreinterpretq_u16_u32(y), vreinterpretq_u16_u32(x)));
+}
+
+#define SHIFTR(x, imm8)                                                        \
+    (vreinterpretq_u32_u8(                                                     \
+        vextq_u8(vreinterpretq_u8_u32(x), vdupq_n_u8(0), imm8)))
+#define BLEND8(x, y, mask) (blend8(x, y, mask))
+#define BLEND16(x, y, imm8) (blend16(x, y, imm8))
+#define SHIFTL16(x, imm8)                                                      \
+    (vreinterpretq_u32_u16(vshlq_n_u16(vreinterpretq_u16_u32(x), imm8)))
+#define SHIFTR16(x, imm8)                                                      \
+    (vreinterpretq_u32_u16(vshrq_n_u16(vreinterpretq_u16_u32(x), imm8)))
+
+/** Load a table of 16 bytes into a register */
+inline VecType load_table16(const uint8_t* table)
+{
+    return vreinterpretq_u32_u8(vld1q_u8(table));
+}
+/** Look up each byte of `idx` (less than 16) in the table */
+inline VecType shuffle8(const VecType& table, const VecType& idx)
+{
+    return vreinterpretq_u32_u8(
+        vqtbl1q_u8(vreinterpretq_u8_u32(table), vreinterpretq_u8_u32(idx)));
+}
+
+/* ================= Essential Operations for NEON ================= */
+
+template <typename T>
+inline VecType set_one(T val);
+template <>
+inline VecType set_one(uint32_t val)
+{
+    return vdupq_n_u32(val);
+}
+template <>
+inline VecType set_one(uint16_t val)
+{
+    return vreinterpretq_u32_u16(vdupq_n_u16(val));
+}
+
+template <typename T>
+inline VecType add(const VecType& x, const VecType& y);
+template <>
+inline VecType add<uint32_t>(const VecType& x, const VecType& y)
+{
+    return vaddq_u32(x, y);
+}
+template <>
+inline VecType add<uint16_t>(const VecType& x, const VecType& y)
+{
+    return vreinterpretq_u32_u16(
+        vaddq_u16(vreinterpretq_u16_u32(x), vreinterpretq_u16_u32(y)));
+}
+
+template <typename T>
+inline VecType sub(const VecType& x, const VecType& y);
+template <>
+inline VecType sub<uint32_t>(const VecType& x, const VecType& y)
+{
+    return vsubq_u32(x, y);
+}
+template <>
+inline VecType sub<uint16_t>(const VecType& x, const VecType& y)
+{
+    return vreinterpretq_u32_u16(
+        vsubq_u16(vreinterpretq_u16_u32(x), vreinterpretq_u16_u32(y)));
+}
+
+template <typename T>
+inline VecType mul(const VecType& x, const VecType& y);
+template <>
+inline VecType mul<uint32_t>(const VecType& x, const VecType& y)
+{
+    return vmulq_u32(x, y);
+}
+template <>
+inline VecType mul<uint16_t>(const VecType& x, const VecType& y)
+{
+    return vreinterpretq_u32_u16(
+        vmulq_u16(vreinterpretq_u16_u32(x), vreinterpretq_u16_u32(y)));
+}
+
+template <typename T>
+inline VecType compare_eq(const VecType& x, const VecType& y);
+template <>
+inline VecType compare_eq<uint32_t>(const VecType& x, const VecType& y)
+{
+    return vceqq_u32(x, y);
+}
+template <>
+inline VecType compare_eq<uint16_t>(const VecType& x, const VecType& y)
+{
+    return vreinterpretq_u32_u16(
+        vceqq_u16(vreinterpretq_u16_u32(x), vreinterpretq_u16_u32(y)));
+}
+
+template <typename T>
+inline VecType min(const VecType& x, const VecType& y);
+template <>
+inline VecType min<uint32_t>(const VecType& x, const VecType& y)
+{
+    return vminq_u32(x, y);
+}
+template <>
+inline VecType min<uint16_t>(const VecType& x, const VecType& y)
+{
+    return vreinterpretq_u32_u16(
+        vminq_u16(vreinterpretq_u16_u32(x), vreinterpretq_u16_u32(y)));
+}
+
+} // namespace QUADIRON_SIMD_NS
+} // namespace simd
+} // namespace quadiron
+
+#endif
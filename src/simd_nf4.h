@@ -37,6 +37,7 @@
 
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_NS {
 
 typedef uint32_t aint32 __attribute__((aligned(ALIGNMENT)));
 
@@ -157,48 +158,65 @@ inline __uint128_t pack(__uint128_t a, uint32_t flag)
 
 /* ================= Basic operations for NF4 ================= */
 
-#if defined(__AVX2__)
+#if QUADIRON_SIMD_BITSZ == 512
 
-inline VecType load_to_reg(HalfVecType x)
+inline VecType load_to_reg(__m128i x)
 {
-    return _mm256_castsi128_si256(_mm_load_si128(&x));
+    return _mm512_castsi128_si512(_mm_load_si128(&x));
 }
 
-inline VecType load_to_reg(__uint128_t x)
+inline void store_low_128_to_mem(__m128i* address, VecType reg)
 {
-    const HalfVecType* _x = reinterpret_cast<const HalfVecType*>(&x);
-    return load_to_reg(*_x);
+    _mm_store_si128(address, low_128(reg));
+}
+
+#elif QUADIRON_SIMD_BITSZ == 256
+
+inline VecType load_to_reg(__m128i x)
+{
+    return _mm256_castsi128_si256(_mm_load_si128(&x));
 }
 
-inline void store_low_half_to_mem(HalfVecType* address, VecType reg)
+inline void store_low_128_to_mem(__m128i* address, VecType reg)
 {
     _mm_store_si128(address, _mm256_castsi256_si128(reg));
 }
 
+#endif
+
+// A NF4 element only fills 128 bits: wider registers work on their low part.
+#if QUADIRON_SIMD_BITSZ == 512 || QUADIRON_SIMD_BITSZ == 256
+
+inline VecType load_to_reg(__uint128_t x)
+{
+    const __m128i* _x = reinterpret_cast<const __m128i*>(&x);
+    return load_to_reg(*_x);
+}
+
 inline __uint128_t add(__uint128_t a, __uint128_t b)
 {
-    HalfVecType res;
+    __m128i res;
     VecType vec_a = load_to_reg(a);
     VecType vec_b = load_to_reg(b);
-    store_low_half_to_mem(&res, mod_add<uint32_t>(vec_a, vec_b));
+    store_low_128_to_mem(&res, mod_add<uint32_t>(vec_a, vec_b));
     return reinterpret_cast<__uint128_t>(res);
 }
 
 inline __uint128_t sub(__uint128_t a, __uint128_t b)
 {
-    HalfVecType res;
+    __m128i res;
     VecType vec_a = load_to_reg(a);
     VecType vec_b = load_to_reg(b);
-    store_low_half_to_mem(&res, mod_sub<uint32_t>(vec_a, vec_b));
+    store_low_128_to_mem(&res, mod_sub<uint32_t>(vec_a, vec_b));
     return reinterpret_cast<__uint128_t>(res);
 }
 
 inline __uint128_t mul(__uint128_t a, __uint128_t b)
 {
-    HalfVecType res;
+    __m128i res;
     VecType vec_a = load_to_reg(a);
     VecType vec_b = load_to_reg(b);
-    store_low_half_to_mem(&res, mod_mul_safe<uint32_t>(vec_a, vec_b));
+    store_low_128_to_mem(&res, mod_mul_safe<uint32_t>(vec_a, vec_b));
     return reinterpret_cast<__uint128_t>(res);
 }
 
@@ -209,28 +227,28 @@ inline void add_buf_to_two_bufs_rem(
     __uint128_t* y)
 {
     // add last _y[] to x and x_next
-    HalfVecType* _x = reinterpret_cast<HalfVecType*>(x);
-    HalfVecType* _x_half = reinterpret_cast<HalfVecType*>(x_half);
-    HalfVecType* _y = reinterpret_cast<HalfVecType*>(y);
+    __m128i* _x = reinterpret_cast<__m128i*>(x);
+    __m128i* _x_half = reinterpret_cast<__m128i*>(x_half);
+    __m128i* _y = reinterpret_cast<__m128i*>(y);
     for (unsigned i = 0; i < n; ++i) {
         VecType _x_p = load_to_reg(_x[i]);
         VecType _x_next_p = load_to_reg(_x_half[i]);
         VecType _y_p = load_to_reg(_y[i]);
 
-        store_low_half_to_mem(_x + i, mod_add<uint32_t>(_x_p, _y_p));
-        store_low_half_to_mem(_x_half + i, mod_add<uint32_t>(_x_next_p, _y_p));
+        store_low_128_to_mem(_x + i, mod_add<uint32_t>(_x_p, _y_p));
+        store_low_128_to_mem(_x_half + i, mod_add<uint32_t>(_x_next_p, _y_p));
     }
 }
 
 inline void hadamard_mul_rem(unsigned n, __uint128_t* x, __uint128_t* y)
 {
-    HalfVecType* _x = reinterpret_cast<HalfVecType*>(x);
-    HalfVecType* _y = reinterpret_cast<HalfVecType*>(y);
+    __m128i* _x = reinterpret_cast<__m128i*>(x);
+    __m128i* _y = reinterpret_cast<__m128i*>(y);
     for (unsigned i = 0; i < n; ++i) {
         VecType _x_p = load_to_reg(_x[i]);
         VecType _y_p = load_to_reg(_y[i]);
 
-        store_low_half_to_mem(_x + i, mod_mul_safe<uint32_t>(_x_p, _y_p));
+        store_low_128_to_mem(_x + i, mod_mul_safe<uint32_t>(_x_p, _y_p));
     }
 }
 
@@ -240,21 +258,21 @@ inline void hadamard_mul_doubled_rem(
     __uint128_t* x_half,
     __uint128_t* y)
 {
-    HalfVecType* _x = reinterpret_cast<HalfVecType*>(x);
-    HalfVecType* _x_half = reinterpret_cast<HalfVecType*>(x_half);
-    HalfVecType* _y = reinterpret_cast<HalfVecType*>(y);
+    __m128i* _x = reinterpret_cast<__m128i*>(x);
+    __m128i* _x_half = reinterpret_cast<__m128i*>(x_half);
+    __m128i* _y = reinterpret_cast<__m128i*>(y);
     for (unsigned i = 0; i < n; ++i) {
         VecType _x_p = load_to_reg(_x[i]);
         VecType _x_next_p = load_to_reg(_x_half[i]);
         VecType _y_p = load_to_reg(_y[i]);
 
-        store_low_half_to_mem(_x + i, mod_mul_safe<uint32_t>(_x_p, _y_p));
-        store_low_half_to_mem(
+        store_low_128_to_mem(_x + i, mod_mul_safe<uint32_t>(_x_p, _y_p));
+        store_low_128_to_mem(
             _x_half + i, mod_mul_safe<uint32_t>(_x_next_p, _y_p));
     }
 }
 
-#elif defined(__SSE4_1__)
+#elif QUADIRON_SIMD_BITSZ == 128
 
 inline VecType load_to_reg(__uint128_t x)
 {
@@ -364,6 +382,7 @@ inline void hadamard_mul(unsigned n, __uint128_t* _x, __uint128_t* _y)
     }
 }
 
+} // namespace QUADIRON_SIMD_NS
 } // namespace simd
 } // namespace quadiron
 
@@ -31,12 +31,11 @@
 #ifndef __QUAD_SIMD_RADIX2_FFT_H__
 #define __QUAD_SIMD_RADIX2_FFT_H__
 
-#include <x86intrin.h>
-
 #include "vec_buffers.h"
 
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_NS {
 
 enum class CtGsCase {
     SIMPLE,
@@ -58,6 +57,17 @@ constexpr CtGsCase get_case(T r, T q)
 
 /* ================= Vectorized Operations ================= */
 
+/*
+ * All butterflies below keep their operands fully reduced, i.e. in [0, q).
+ *
+ * A lazy range such as [0, 2q) does not pay off for the Fermat moduli:
+ * - `mod_mul` relies on the 16-bit (resp. 32-bit) low product, which
+ *   overflows as soon as one operand exceeds q, so the multiplied operand
+ *   must be reduced anyway;
+ * - each extra q of headroom costs one `min`/`sub` pair to remove, which
+ *   is exactly what `mod_add` and `mod_sub` spend per operation.
+ */
+
 /**
  * Butterfly Cooley-Tukey operation
  *
@@ -432,6 +442,133 @@ inline void butterfly_gs_step_simple(
     }
 }
 
+template <typename T>
+inline void do_butterfly_gs_2_layers(
+    const std::vector<T*>& mem,
+    T r1,
+    T r2,
+    T r3,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    const CtGsCase case1 = get_case<T>(r1, card);
+    const CtGsCase case2 = get_case<T>(r2, card);
+    const CtGsCase case3 = get_case<T>(r3, card);
+
+    VecType c1 = set_one(r1);
+    VecType c2 = set_one(r2);
+    VecType c3 = set_one(r3);
+
+    VecType* p = reinterpret_cast<VecType*>(mem[start]);
+    VecType* q = reinterpret_cast<VecType*>(mem[start + m]);
+    VecType* r = reinterpret_cast<VecType*>(mem[start + 2 * m]);
+    VecType* s = reinterpret_cast<VecType*>(mem[start + 3 * m]);
+
+    size_t j = 0;
+    const size_t end = (len > 1) ? len - 1 : 0;
+    while (j < end) {
+        VecType x1 = load_to_reg(p);
+        VecType y1 = load_to_reg(q);
+        VecType u1 = load_to_reg(r);
+        VecType v1 = load_to_reg(s);
+
+        butterfly_gs<T>(case2, c2, x1, u1);
+        butterfly_gs<T>(case3, c3, y1, v1);
+        butterfly_gs<T>(case1, c1, x1, y1);
+        butterfly_gs<T>(case1, c1, u1, v1);
+
+        VecType x2 = load_to_reg(p + 1);
+        VecType y2 = load_to_reg(q + 1);
+        VecType u2 = load_to_reg(r + 1);
+        VecType v2 = load_to_reg(s + 1);
+
+        butterfly_gs<T>(case2, c2, x2, u2);
+        butterfly_gs<T>(case3, c3, y2, v2);
+        butterfly_gs<T>(case1, c1, x2, y2);
+        butterfly_gs<T>(case1, c1, u2, v2);
+
+        store_to_mem(p++, x1);
+        store_to_mem(p++, x2);
+        store_to_mem(q++, y1);
+        store_to_mem(q++, y2);
+        store_to_mem(r++, u1);
+        store_to_mem(r++, u2);
+        store_to_mem(s++, v1);
+        store_to_mem(s++, v2);
+
+        j += 2;
+    }
+    for (; j < len; ++j) {
+        VecType x1 = load_to_reg(p);
+        VecType y1 = load_to_reg(q);
+        VecType u1 = load_to_reg(r);
+        VecType v1 = load_to_reg(s);
+
+        butterfly_gs<T>(case2, c2, x1, u1);
+        butterfly_gs<T>(case3, c3, y1, v1);
+        butterfly_gs<T>(case1, c1, x1, y1);
+        butterfly_gs<T>(case1, c1, u1, v1);
+
+        store_to_mem(p++, x1);
+        store_to_mem(q++, y1);
+        store_to_mem(r++, u1);
+        store_to_mem(s++, v1);
+    }
+}
+
+/**
+ * Vectorized butterfly GS on two-layers at a time
+ *
+ * For each quadruple
+ * (P, Q, R, S) = (buf[i], buf[i + m], buf[i + 2 * m], buf[i + 3 * m])
+ * First layer: butterfly on (P, R) and (Q, S) for step = 4 * m
+ *      coef r2 = inv_W[start * n / (4 * m)]
+ *      coef r3 = inv_W[(start + m) * n / (4 * m)]
+ *      P = P + R
+ *      R = r2 * (P - R)
+ *      Q = Q + S
+ *      S = r3 * (Q - S)
+ * Second layer: butterfly on (P, Q) and (R, S) for step = 2 * m
+ *      coef r1 = inv_W[start * n / (2 * m)]
+ *      P = P + Q
+ *      Q = r1 * (P - Q)
+ *      R = R + S
+ *      S = r1 * (R - S)
+ *
+ * @param buf - working buffers
+ * @param r1 - coefficient for the 2nd layer
+ * @param r2 - 1st coefficient for the 1st layer
+ * @param r3 - 2nd coefficient for the 1st layer
+ * @param start - index of buffer among `m` ones
+ * @param m - group size of the 2nd layer
+ * @param len - number of vectors per buffer
+ * @param card - modulo cardinal
+ */
+template <typename T>
+inline void butterfly_gs_two_layers_step(
+    vec::Buffers<T>& buf,
+    T r1,
+    T r2,
+    T r3,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    if (len == 0) {
+        return;
+    }
+    const unsigned step = m << 2;
+    const unsigned bufs_nb = buf.get_n();
+
+    const std::vector<T*>& mem = buf.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        do_butterfly_gs_2_layers(mem, r1, r2, r3, i, m, len, card);
+    }
+}
+
 template <typename T>
 inline void encode_post_process(
     vec::Buffers<T>& output,
@@ -441,7 +578,7 @@ inline void encode_post_process(
     T threshold,
     size_t vecs_nb)
 {
-    const unsigned vec_size = countof<T>();
+    const unsigned vec_size = sizeof(VecType) / sizeof(T);
     const T max = 1U << (sizeof(T) * CHAR_BIT - 1);
     const VecType _threshold = set_one(threshold);
     const VecType mask_hi = set_one(max);
@@ -490,6 +627,7 @@ inline void encode_post_process(
     }
 }
 
+} // namespace QUADIRON_SIMD_NS
 } // namespace simd
 } // namespace quadiron
 
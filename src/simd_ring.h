@@ -31,10 +31,9 @@
 #ifndef __QUAD_SIMD_RING_H__
 #define __QUAD_SIMD_RING_H__
 
-#include <x86intrin.h>
-
 namespace quadiron {
 namespace simd {
+inline namespace QUADIRON_SIMD_NS {
 
 /* ==================== Operations for RingModN =================== */
 /** Perform a multiplication of a coefficient `a` to each element of `src` and
@@ -65,12 +64,22 @@ inline void mul_coef_to_buf(const T a, T* src, T* dest, size_t len, T card)
         _dest[i] = mod_mul<T>(coef, _src[i]);
     }
 
+#if QUADIRON_SIMD_BITSZ == 512
+    // The modulus is built in the vectorized operations.
+    (void)card;
+    if (_last_len > 0) {
+        const size_t offset = _len * ratio;
+        const VecType x = load_first(src + offset, _last_len);
+        store_first(dest + offset, mod_mul<T>(coef, x), _last_len);
+    }
+#else
     if (_last_len > 0) {
         const DoubleSizeVal<T> coef_double = DoubleSizeVal<T>(a);
         for (size_t i = _len * ratio; i < len; i++) {
             dest[i] = static_cast<T>((coef_double * src[i]) % card);
         }
     }
+#endif
 }
 
 template <typename T>
@@ -86,12 +95,22 @@ inline void add_two_bufs(T* src, T* dest, size_t len, T card)
     for (i = 0; i < _len; i++) {
         _dest[i] = mod_add<T>(_src[i], _dest[i]);
     }
+#if QUADIRON_SIMD_BITSZ == 512
+    (void)card;
+    if (_last_len > 0) {
+        const size_t offset = _len * ratio;
+        const VecType x = load_first(src + offset, _last_len);
+        const VecType y = load_first(dest + offset, _last_len);
+        store_first(dest + offset, mod_add<T>(x, y), _last_len);
+    }
+#else
     if (_last_len > 0) {
         for (i = _len * ratio; i < len; i++) {
             const T tmp = src[i] + dest[i];
             dest[i] = (tmp >= card) ? (tmp - card) : tmp;
         }
     }
+#endif
 }
 
 template <typename T>
@@ -109,6 +128,15 @@ inline void sub_two_bufs(T* bufa, T* bufb, T* res, size_t len, T card)
         // perform subtraction
         _res[i] = mod_sub<T>(_bufa[i], _bufb[i]);
     }
+#if QUADIRON_SIMD_BITSZ == 512
+    (void)card;
+    if (_last_len > 0) {
+        const size_t offset = _len * ratio;
+        const VecType x = load_first(bufa + offset, _last_len);
+        const VecType y = load_first(bufb + offset, _last_len);
+        store_first(res + offset, mod_sub<T>(x, y), _last_len);
+    }
+#else
     if (_last_len > 0) {
         for (i = _len * ratio; i < len; i++) {
             // perform subtraction
@@ -119,6 +147,7 @@ inline void sub_two_bufs(T* bufa, T* bufb, T* res, size_t len, T card)
             }
         }
     }
+#endif
 }
 
 template <typename T>
@@ -135,12 +164,22 @@ inline void mul_two_bufs(T* src, T* dest, size_t len, T card)
         // perform multiplicaton
         _dest[i] = mod_mul_safe<T>(_src[i], _dest[i]);
     }
+#if QUADIRON_SIMD_BITSZ == 512
+    (void)card;
+    if (_last_len > 0) {
+        const size_t offset = _len * ratio;
+        const VecType x = load_first(src + offset, _last_len);
+        const VecType y = load_first(dest + offset, _last_len);
+        store_first(dest + offset, mod_mul_safe<T>(x, y), _last_len);
+    }
+#else
     if (_last_len > 0) {
         for (i = _len * ratio; i < len; i++) {
             // perform multiplicaton
             dest[i] = T((DoubleSizeVal<T>(src[i]) * dest[i]) % card);
         }
     }
+#endif
 }
 
 /** Apply an element-wise negation to a buffer
@@ -157,14 +196,24 @@ inline void neg(size_t len, T* buf, T card)
     for (i = 0; i < _len; i++) {
         _buf[i] = mod_neg<T>(_buf[i]);
     }
+#if QUADIRON_SIMD_BITSZ == 512
+    (void)card;
+    if (_last_len > 0) {
+        const size_t offset = _len * ratio;
+        const VecType x = load_first(buf + offset, _last_len);
+        store_first(buf + offset, mod_neg<T>(x), _last_len);
+    }
+#else
     if (_last_len > 0) {
         for (i = _len * ratio; i < len; i++) {
             if (buf[i])
                 buf[i] = card - buf[i];
         }
     }
+#endif
 }
 
+} // namespace QUADIRON_SIMD_NS
 } // namespace simd
 } // namespace quadiron
 
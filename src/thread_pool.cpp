@@ -0,0 +1,118 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "thread_pool.h"
+
+namespace quadiron {
+
+ThreadPool::ThreadPool(unsigned n_workers)
+{
+    workers.reserve(n_workers);
+    for (unsigned i = 0; i < n_workers; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start_cond.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t n_tasks, const std::function<void(size_t)>& task)
+{
+    std::lock_guard<std::mutex> run_lock(run_mutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        n_jobs = n_tasks;
+        next_job = 0;
+        error = nullptr;
+        n_pending = size();
+        generation++;
+    }
+    start_cond.notify_all();
+
+    // The caller takes its share of the work.
+    execute();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cond.wait(lock, [this] { return n_pending == 0; });
+    job = nullptr;
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::worker_loop()
+{
+    uint64_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cond.wait(
+                lock, [this, seen] { return stop || generation != seen; });
+            if (stop) {
+                return;
+            }
+            seen = generation;
+        }
+
+        execute();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--n_pending == 0) {
+            done_cond.notify_one();
+        }
+    }
+}
+
+void ThreadPool::execute()
+{
+    for (size_t i = next_job++; i < n_jobs; i = next_job++) {
+        try {
+            (*job)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+}
+
+} // namespace quadiron
@@ -0,0 +1,104 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_THREAD_POOL_H__
+#define __QUAD_THREAD_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quadiron {
+
+/** A fixed-size pool of worker threads.
+ *
+ * The pool executes batches of independent tasks: `run` hands out task
+ * indices to the workers *and* to the calling thread, and returns once every
+ * task of the batch is done. Thus a pool of `n` workers runs up to `n + 1`
+ * tasks at once.
+ *
+ * Only one batch can be in flight at a time: concurrent calls to `run` are
+ * serialized.
+ */
+class ThreadPool {
+  public:
+    explicit ThreadPool(unsigned n_workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** Return the number of worker threads (the caller excluded). */
+    unsigned size() const
+    {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    /** Run `task(i)` for each `i` in [0, n_tasks).
+     *
+     * @param n_tasks number of tasks
+     * @param task function called with the index of the task to run
+     *
+     * @note if a task throws, the remaining tasks are still executed and the
+     * first exception is rethrown to the caller.
+     */
+    void run(size_t n_tasks, const std::function<void(size_t)>& task);
+
+  private:
+    void worker_loop();
+    void execute();
+
+    std::vector<std::thread> workers;
+
+    // Serialize calls to `run`.
+    std::mutex run_mutex;
+
+    // Protect the batch description below.
+    std::mutex mutex;
+    std::condition_variable start_cond;
+    std::condition_variable done_cond;
+    uint64_t generation = 0;
+    unsigned n_pending = 0;
+    bool stop = false;
+
+    const std::function<void(size_t)>* job = nullptr;
+    size_t n_jobs = 0;
+    std::atomic<size_t> next_job{0};
+    std::exception_ptr error = nullptr;
+};
+
+} // namespace quadiron
+
+#endif
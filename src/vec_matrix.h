@@ -34,6 +34,7 @@
 #include <iostream>
 
 #include "gf_ring.h"
+#include "vec_buffers.h"
 #include "vec_vector.h"
 
 namespace quadiron {
@@ -65,6 +66,7 @@ class Matrix {
     virtual const T& get(int i, int j);
     void inv(void);
     void mul(vec::Vector<T>* output, vec::Vector<T>* v);
+    void mul(vec::Buffers<T>* output, vec::Buffers<T>* input);
     void vandermonde(void);
     void vandermonde_suitable_for_ec(void);
     void cauchy(void);
@@ -403,6 +405,55 @@ void Matrix<T>::mul(vec::Vector<T>* output, vec::Vector<T>* v)
     }
 }
 
+/** Multiply the matrix by a column of buffers
+ *
+ * Each output buffer accumulates `coef * input_buffer` over the whole packet,
+ * so that a row costs one pass per nonzero coefficient.
+ *
+ * @note The coefficients are given to `mul_coef_to_buf` and
+ * `mul_coef_add_to_buf` which may take shortcuts for some values (e.g. `card
+ * - 1` in FNT), hence the ring must support them for any coefficient.
+ *
+ * @param output buffers of `n_rows` elements
+ * @param input buffers of `n_cols` elements
+ */
+template <typename T>
+void Matrix<T>::mul(vec::Buffers<T>* output, vec::Buffers<T>* input)
+{
+    assert(get_n_cols() == input->get_n());
+    assert(get_n_rows() == output->get_n());
+    assert(input->get_size() == output->get_size());
+
+    const size_t len = input->get_size();
+
+    for (int i = 0; i < n_rows; i++) {
+        T* dest = output->get(i);
+        bool is_set = false;
+        for (int j = 0; j < n_cols; j++) {
+            const T coef = get(i, j);
+            T* src = input->get(j);
+            if (coef == 0) {
+                continue;
+            }
+            if (!is_set) {
+                if (coef == 1) {
+                    std::copy_n(src, len, dest);
+                } else {
+                    rn->mul_coef_to_buf(coef, src, dest, len);
+                }
+                is_set = true;
+            } else if (coef == 1) {
+                rn->add_two_bufs(src, dest, len);
+            } else {
+                rn->mul_coef_add_to_buf(coef, src, dest, len);
+            }
+        }
+        if (!is_set) {
+            std::fill_n(dest, len, 0);
+        }
+    }
+}
+
 template <typename T>
 void Matrix<T>::cauchy()
 {
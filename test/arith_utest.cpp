@@ -327,6 +327,39 @@ TYPED_TEST(ArithTestNo128, TestExtendedGcd) // NOLINT
     ASSERT_TRUE(bezout[0] == -7 && bezout[1] == 34);
 }
 
+TYPED_TEST(ArithTestNo128, TestMulShoup) // NOLINT
+{
+    const unsigned width = sizeof(TypeParam) * CHAR_BIT;
+    std::vector<TypeParam> moduli = {257, 12289, 65537, 2147483647};
+    if (width == 64) {
+        moduli.push_back(static_cast<TypeParam>(4294991873ULL));
+        moduli.push_back((static_cast<TypeParam>(1) << 61) - 1);
+    }
+    ASSERT_FALSE(arith::is_shoup_modulus<TypeParam>(
+        static_cast<TypeParam>(1) << (width - 1)));
+
+    std::uniform_int_distribution<uint64_t> dist;
+    for (const TypeParam modulus : moduli) {
+        ASSERT_TRUE(arith::is_shoup_modulus<TypeParam>(modulus));
+
+        std::vector<TypeParam> values = {0, 1, 2, modulus - 2, modulus - 1};
+        for (int i = 0; i < 100; i++) {
+            values.push_back(dist(quadiron::prng()) % modulus);
+        }
+        for (const TypeParam a : values) {
+            const TypeParam a_shoup =
+                arith::shoup_precompute<TypeParam>(a, modulus);
+            for (const TypeParam b : values) {
+                const TypeParam expected = static_cast<TypeParam>(
+                    quadiron::DoubleSizeVal<TypeParam>(a) * b % modulus);
+                ASSERT_EQ(
+                    arith::mul_shoup<TypeParam>(a, a_shoup, b, modulus),
+                    expected);
+            }
+        }
+    }
+}
+
 // Schönhage-Strassen algorithm (example taken from Pierre Meunier's book).
 TEST(ArithTest, TestBignumMultiplication) // NOLINT
 {
@@ -37,6 +37,7 @@
 
 int vflag = 0;
 int tflag = 0;
+int pflag = 0;
 int data_zpad = -1;
 int coding_zpad = -1;
 char* prefix = nullptr;
@@ -47,6 +48,7 @@ static void xusage()
     std::cerr << std::string("Usage: ") +
     "ec [-e rs-gf2n-v|rs-gf2n-c|rs-gf2n-fft|rs-gf2n-fft-add|rs-gfp-fft|rs-fnt|rs-fnt-sys|rs-nf4]" +
     "[-w word_size][-n n_data][-m n_parities][-p prefix][-v (verbose)]" +
+    "[-P (pipelined streams)]" +
     " -c (encode) | -r (repair)\n";
     std::exit(EXIT_FAILURE);
 }
@@ -439,6 +441,7 @@ void run_fec_rs_fnt(
     size_t pkt_size = 1024;
     fec = new quadiron::fec::RsFnt<T>(
         type, word_size, n_data, n_parities, pkt_size);
+    fec->set_stream_pipelining(pflag);
 
     coding_zpad = count_digits(fec->n_outputs - 1);
 
@@ -514,7 +517,7 @@ int main(int argc, char** argv)
     unsigned word_size = 0;
 
     n_data = n_parities = -1;
-    while ((opt = getopt(argc, argv, "n:m:p:cruve:w:t")) != -1) {
+    while ((opt = getopt(argc, argv, "n:m:p:cruve:w:tP")) != -1) {
         switch (opt) {
         case 'e':
             if (!strcmp(optarg, "rs-gf2n-v")) {
@@ -566,6 +569,9 @@ int main(int argc, char** argv)
         case 't':
             tflag = 1;
             break;
+        case 'P':
+            pflag = 1;
+            break;
         default: /* '?' */
             xusage();
         }
@@ -27,6 +27,10 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <numeric>
+#include <sstream>
+#include <string>
+
 #include <gtest/gtest.h>
 
 #include "quadiron.h"
@@ -110,6 +114,71 @@ TYPED_TEST(FecTestCommon, TestNf4) // NOLINT
     }
 }
 
+TYPED_TEST(FecTestCommon, TestNf4Buffers) // NOLINT
+{
+    const int iter_count = arith::log2<TypeParam>(sizeof(TypeParam));
+    const size_t pkt_size = 1024;
+    const unsigned code_len = this->n_data + this->n_parities;
+
+    for (int i = 1; i < iter_count; i++) {
+        const unsigned word_size = 1 << i;
+        fec::RsNf4<TypeParam> rs_nf4(
+            word_size, this->n_data, this->n_parities, pkt_size);
+        fec::FecCode<TypeParam>& fec = rs_nf4;
+        const quadiron::gf::NF4<TypeParam>& nf4 =
+            static_cast<const quadiron::gf::NF4<TypeParam>&>(fec.get_gf());
+
+        std::vector<int> ids(code_len);
+        std::iota(ids.begin(), ids.end(), 0);
+        vec::Vector<TypeParam> fragments_ids(nf4, this->n_data);
+
+        for (int j = 0; j < 20; j++) {
+            vec::Buffers<TypeParam> words(this->n_data, pkt_size);
+            vec::Buffers<TypeParam> encoded(fec.n, pkt_size);
+            vec::Buffers<TypeParam> received(this->n_data, pkt_size);
+            vec::Buffers<TypeParam> decoded(this->n_data, pkt_size);
+            std::vector<quadiron::Properties> props(fec.n);
+            for (unsigned k = 0; k < this->n_data; k++) {
+                for (size_t u = 0; u < pkt_size; u++) {
+                    words.get(k)[u] = nf4.unpacked_rand();
+                }
+            }
+            vec::Buffers<TypeParam> data(words, this->n_data);
+
+            fec.encode(encoded, props, 0, words);
+
+            // The planar encoding matches the packed one.
+            vec::Vector<TypeParam> _words(nf4, this->n_data);
+            vec::Vector<TypeParam> _encoded(nf4, fec.n);
+            std::vector<quadiron::Properties> _props(fec.n);
+            for (size_t u = 0; u < pkt_size; u++) {
+                for (unsigned k = 0; k < this->n_data; k++) {
+                    _words.set(k, data.get(k)[u]);
+                }
+                fec.encode(_encoded, _props, u, _words);
+                for (unsigned k = 0; k < code_len; k++) {
+                    ASSERT_EQ(_encoded.get(k), encoded.get(k)[u]);
+                }
+            }
+            for (unsigned k = 0; k < code_len; k++) {
+                ASSERT_EQ(_props[k].get_map(), props[k].get_map());
+            }
+
+            std::random_shuffle(ids.begin(), ids.end());
+            for (unsigned k = 0; k < this->n_data; k++) {
+                fragments_ids.set(k, ids.at(k));
+                received.copy(k, encoded.get(ids.at(k)));
+            }
+            std::unique_ptr<fec::DecodeContext<TypeParam>> context =
+                fec.init_context_dec(fragments_ids, props, pkt_size, &decoded);
+
+            fec.decode(*context, decoded, props, 0, received);
+
+            ASSERT_EQ(decoded, data);
+        }
+    }
+}
+
 TYPED_TEST(FecTestCommon, TestGf2nFft) // NOLINT
 {
     for (size_t wordsize = 1; wordsize <= sizeof(TypeParam); wordsize *= 2) {
@@ -131,6 +200,619 @@ TYPED_TEST(FecTestCommon, TestGf2nFftAdd) // NOLINT
 
 template <typename T>
 class FecTestFnt : public FecTestCommon<T> {
+  public:
+    // Check that several threads give the same blocks as a single one.
+    void run_test_blocks_parallel(fec::FecType type, unsigned n_threads)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        // Not a multiple of `pkt_size` to have a trailing packet.
+        const size_t block_size = (1000 * pkt_size + 5) * word_size;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        fec::RsFnt<T> fec_mt(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        fec_mt.set_n_threads(n_threads);
+        ASSERT_EQ(fec_mt.get_n_threads(), n_threads);
+
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::vector<uint8_t>> data(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> parities_mt(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(this->n_data);
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        std::vector<uint8_t*> parities_mt_bufs(n_outputs);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            parities_bufs[i] = parities[i].data();
+            parities_mt_bufs[i] = parities_mt[i].data();
+        }
+
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<quadiron::Properties> props_mt(n_outputs);
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+        fec_mt.encode_blocks_vertical(
+            data_bufs, parities_mt_bufs, props_mt, wanted_idxs, block_size);
+
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            ASSERT_EQ(parities[i], parities_mt[i]);
+            ASSERT_EQ(props[i].get_map(), props_mt[i].get_map());
+        }
+
+        // Lose as many fragments as possible, starting with the data ones.
+        const bool systematic = type == fec::FecType::SYSTEMATIC;
+        const unsigned n_frags = systematic ? this->n_data + n_outputs
+                                            : n_outputs;
+        const unsigned n_missing = n_frags - this->n_data;
+        std::vector<int> missing_idxs(n_frags, 0);
+        std::fill_n(missing_idxs.begin(), n_missing, 1);
+
+        std::vector<std::vector<uint8_t>> decoded(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> decoded_bufs(this->n_data);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            decoded_bufs[i] = decoded[i].data();
+        }
+        std::vector<bool> wanted_data_idxs(this->n_data, true);
+
+        ASSERT_TRUE(fec_mt.decode_blocks_vertical(
+            decoded_bufs,
+            parities_mt_bufs,
+            props_mt,
+            missing_idxs,
+            wanted_data_idxs,
+            block_size));
+
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            ASSERT_EQ(data[i], decoded[i]);
+        }
+    }
+
+    // Check that encoding several stripes at once gives the same parities
+    // and properties as encoding each stripe on its own.
+    void run_test_encode_stripes(fec::FecType type, unsigned n_threads)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        const size_t block_size = (10 * pkt_size + 5) * word_size;
+        const size_t n_stripes = 5;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        fec::RsFnt<T> fec_batch(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        fec_batch.set_n_threads(n_threads);
+
+        const unsigned n_outputs = fec.n_outputs;
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        std::vector<std::vector<std::vector<uint8_t>>> data(n_stripes);
+        std::vector<std::vector<std::vector<uint8_t>>> parities(n_stripes);
+        std::vector<std::vector<std::vector<uint8_t>>> parities_batch(
+            n_stripes);
+        std::vector<std::vector<uint8_t*>> data_bufs(n_stripes);
+        std::vector<std::vector<uint8_t*>> parities_bufs(n_stripes);
+        std::vector<std::vector<uint8_t*>> parities_batch_bufs(n_stripes);
+        std::vector<std::vector<quadiron::Properties>> props_batch(
+            n_stripes, std::vector<quadiron::Properties>(n_outputs));
+
+        for (size_t s = 0; s < n_stripes; ++s) {
+            data[s].assign(this->n_data, std::vector<uint8_t>(block_size));
+            parities[s].assign(n_outputs, std::vector<uint8_t>(block_size));
+            parities_batch[s].assign(
+                n_outputs, std::vector<uint8_t>(block_size));
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                for (auto& byte : data[s][i]) {
+                    byte = static_cast<uint8_t>(rand());
+                }
+                data_bufs[s].push_back(data[s][i].data());
+            }
+            for (unsigned i = 0; i < n_outputs; ++i) {
+                parities_bufs[s].push_back(parities[s][i].data());
+                parities_batch_bufs[s].push_back(parities_batch[s][i].data());
+            }
+        }
+
+        fec_batch.encode_stripes_vertical(
+            data_bufs,
+            parities_batch_bufs,
+            props_batch,
+            wanted_idxs,
+            block_size);
+
+        for (size_t s = 0; s < n_stripes; ++s) {
+            std::vector<quadiron::Properties> props(n_outputs);
+            fec.encode_blocks_vertical(
+                data_bufs[s], parities_bufs[s], props, wanted_idxs, block_size);
+
+            for (unsigned i = 0; i < n_outputs; ++i) {
+                ASSERT_EQ(parities[s][i], parities_batch[s][i]);
+                ASSERT_EQ(props[i].get_map(), props_batch[s][i].get_map());
+            }
+        }
+    }
+
+    // Check that the pipelined vertical stream functions give the same
+    // streams as the sequential ones, and recover the data.
+    void run_test_streams_pipelined(fec::FecType type)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        // Not a multiple of the chunk size to have a trailing chunk.
+        const size_t stream_size = (10 * pkt_size + 5) * word_size;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        fec::RsFnt<T> fec_pp(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        fec_pp.set_stream_pipelining(true);
+        ASSERT_TRUE(fec_pp.get_stream_pipelining());
+
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::string> data(this->n_data);
+        for (auto& str : data) {
+            for (size_t i = 0; i < stream_size; ++i) {
+                str.push_back(static_cast<char>(rand()));
+            }
+        }
+
+        auto encode = [&](fec::FecCode<T>& code,
+                          std::vector<std::string>& parities,
+                          std::vector<quadiron::Properties>& props) {
+            std::vector<std::istringstream> d_streams;
+            std::vector<std::ostringstream> c_streams(n_outputs);
+            std::vector<std::istream*> d_bufs;
+            std::vector<std::ostream*> c_bufs;
+            for (const auto& str : data) {
+                d_streams.emplace_back(str);
+            }
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                d_bufs.push_back(&d_streams[i]);
+            }
+            for (auto& stream : c_streams) {
+                c_bufs.push_back(&stream);
+            }
+            code.encode_streams_vertical(d_bufs, c_bufs, props);
+            for (unsigned i = 0; i < n_outputs; ++i) {
+                parities[i] = c_streams[i].str();
+            }
+        };
+
+        std::vector<std::string> parities(n_outputs);
+        std::vector<std::string> parities_pp(n_outputs);
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<quadiron::Properties> props_pp(n_outputs);
+        encode(fec, parities, props);
+        encode(fec_pp, parities_pp, props_pp);
+
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            ASSERT_EQ(parities[i], parities_pp[i]);
+            ASSERT_EQ(props[i].get_map(), props_pp[i].get_map());
+        }
+
+        // Lose all data, and the first parity if others are enough.
+        std::vector<std::istringstream> c_streams;
+        std::vector<std::istream*> d_bufs(this->n_data, nullptr);
+        std::vector<std::istream*> c_bufs(n_outputs, nullptr);
+        for (const auto& str : parities_pp) {
+            c_streams.emplace_back(str);
+        }
+        for (unsigned i = n_outputs - this->n_data; i < n_outputs; ++i) {
+            c_bufs[i] = &c_streams[i];
+        }
+        std::vector<std::ostringstream> r_streams(this->n_data);
+        std::vector<std::ostream*> r_bufs;
+        for (auto& stream : r_streams) {
+            r_bufs.push_back(&stream);
+        }
+
+        ASSERT_TRUE(
+            fec_pp.decode_streams_vertical(d_bufs, c_bufs, props_pp, r_bufs));
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            ASSERT_EQ(data[i], r_streams[i].str());
+        }
+    }
+
+    // Check that decoding blocks with the same erasure pattern again reuses
+    // the decoding contexts, and still gives the original data.
+    void run_test_decode_cache(fec::FecType type)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        const size_t block_size = (10 * pkt_size + 5) * word_size;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        fec.set_decode_cache_capacity(1);
+        ASSERT_EQ(fec.get_decode_cache_capacity(), 1);
+
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::vector<uint8_t>> data(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(this->n_data);
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            parities_bufs[i] = parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+        const bool systematic = type == fec::FecType::SYSTEMATIC;
+        const unsigned n_frags = systematic ? this->n_data + n_outputs
+                                            : n_outputs;
+
+        // Decode with the fragments in `[first_missing, first_missing +
+        // n_frags - n_data)` lost.
+        auto decode = [&](unsigned first_missing) {
+            std::vector<int> missing_idxs(n_frags, 0);
+            std::fill_n(
+                missing_idxs.begin() + first_missing,
+                n_frags - this->n_data,
+                1);
+
+            std::vector<std::vector<uint8_t>> decoded(
+                this->n_data, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> decoded_bufs(this->n_data);
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                if (systematic && !missing_idxs[i]) {
+                    decoded[i] = data[i];
+                }
+                decoded_bufs[i] = decoded[i].data();
+            }
+            std::vector<bool> wanted_data_idxs(this->n_data, true);
+
+            ASSERT_TRUE(fec.decode_blocks_vertical(
+                decoded_bufs,
+                parities_bufs,
+                props,
+                missing_idxs,
+                wanted_data_idxs,
+                block_size));
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                ASSERT_EQ(data[i], decoded[i]);
+            }
+        };
+
+        decode(0);
+        ASSERT_EQ(fec.get_decode_cache_hits(), 0);
+        ASSERT_EQ(fec.get_decode_cache_misses(), 1);
+        decode(0);
+        ASSERT_EQ(fec.get_decode_cache_hits(), 1);
+        ASSERT_EQ(fec.get_decode_cache_misses(), 1);
+        // Another pattern evicts the first one.
+        decode(1);
+        decode(0);
+        ASSERT_EQ(fec.get_decode_cache_hits(), 1);
+        ASSERT_EQ(fec.get_decode_cache_misses(), 3);
+
+        fec.set_decode_cache_capacity(0);
+        decode(0);
+        decode(0);
+        ASSERT_EQ(fec.get_decode_cache_hits(), 1);
+        ASSERT_EQ(fec.get_decode_cache_misses(), 5);
+    }
+
+    // Check that the per-stage statistics count the stages run by the block
+    // encoding and decoding, and only when they are enabled.
+    void run_test_stage_stats(fec::FecType type)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        const size_t block_size = (4 * pkt_size + 5) * word_size;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+        ASSERT_EQ(fec.get_stage_stats(), nullptr);
+
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::vector<uint8_t>> data(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(this->n_data);
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            parities_bufs[i] = parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        fec.set_stage_stats(true);
+        const fec::StageStats* stats = fec.get_stage_stats();
+        ASSERT_NE(stats, nullptr);
+
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+        const uint64_t n_pkts = 5;
+        ASSERT_EQ(stats->get_calls(fec::Stage::PACK), n_pkts);
+        ASSERT_EQ(stats->get_calls(fec::Stage::UNPACK), n_pkts);
+        ASSERT_EQ(stats->get_calls(fec::Stage::POST_PROCESS), n_pkts);
+        ASSERT_GE(stats->get_calls(fec::Stage::FFT), n_pkts);
+        ASSERT_EQ(stats->get_calls(fec::Stage::COPY), 2 * n_pkts);
+        ASSERT_EQ(stats->get_calls(fec::Stage::CONTEXT_BUILD), 0);
+        ASSERT_GT(stats->get_cycles(fec::Stage::FFT), 0);
+
+        fec.reset_stage_stats();
+        ASSERT_EQ(stats->get_calls(fec::Stage::PACK), 0);
+        ASSERT_EQ(stats->get_cycles(fec::Stage::PACK), 0);
+
+        // Decode with the first `n_parities` fragments lost.
+        const bool systematic = type == fec::FecType::SYSTEMATIC;
+        const unsigned n_frags = systematic ? this->n_data + n_outputs
+                                            : n_outputs;
+        std::vector<int> missing_idxs(n_frags, 0);
+        std::fill_n(missing_idxs.begin(), n_frags - this->n_data, 1);
+        std::vector<std::vector<uint8_t>> decoded(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> decoded_bufs(this->n_data);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            if (systematic && !missing_idxs[i]) {
+                decoded[i] = data[i];
+            }
+            decoded_bufs[i] = decoded[i].data();
+        }
+        std::vector<bool> wanted_data_idxs(this->n_data, true);
+
+        ASSERT_TRUE(fec.decode_blocks_vertical(
+            decoded_bufs,
+            parities_bufs,
+            props,
+            missing_idxs,
+            wanted_data_idxs,
+            block_size));
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            ASSERT_EQ(data[i], decoded[i]);
+        }
+
+        ASSERT_EQ(stats->get_calls(fec::Stage::CONTEXT_BUILD), 1);
+        ASSERT_EQ(stats->get_calls(fec::Stage::PACK), n_pkts);
+        ASSERT_EQ(stats->get_calls(fec::Stage::UNPACK), n_pkts);
+        ASSERT_GE(stats->get_calls(fec::Stage::HADAMARD), 3 * n_pkts);
+        ASSERT_GE(stats->get_calls(fec::Stage::PROPS), n_pkts);
+        ASSERT_EQ(stats->get_calls(fec::Stage::POST_PROCESS), 0);
+
+        fec.set_stage_stats(false);
+        ASSERT_EQ(fec.get_stage_stats(), nullptr);
+    }
+
+    // Check that updating the parities after overwriting a data block gives
+    // the same parities and properties as encoding the new data.
+    void run_test_update_parities(fec::FecType type)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        const size_t block_size = (10 * pkt_size + 5) * word_size;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::vector<uint8_t>> data(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> ref_parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(this->n_data);
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        std::vector<uint8_t*> ref_parities_bufs(n_outputs);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            parities_bufs[i] = parities[i].data();
+            ref_parities_bufs[i] = ref_parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<quadiron::Properties> ref_props(n_outputs);
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+        for (unsigned fragment_index = 0; fragment_index < this->n_data;
+             ++fragment_index) {
+            const std::vector<uint8_t> old_data = data[fragment_index];
+            for (auto& byte : data[fragment_index]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+
+            fec.update_parities(
+                fragment_index,
+                old_data.data(),
+                data[fragment_index].data(),
+                parities_bufs,
+                props,
+                block_size);
+
+            fec.encode_blocks_vertical(
+                data_bufs,
+                ref_parities_bufs,
+                ref_props,
+                wanted_idxs,
+                block_size);
+            for (unsigned i = 0; i < n_outputs; ++i) {
+                ASSERT_EQ(parities[i], ref_parities[i]);
+                ASSERT_EQ(props[i].get_map(), ref_props[i].get_map());
+            }
+        }
+
+        ASSERT_THROW(
+            fec.update_parities(
+                this->n_data,
+                data[0].data(),
+                data[0].data(),
+                parities_bufs,
+                props,
+                block_size),
+            quadiron::InvalidArgument);
+    }
+
+    // Check that repairing each fragment, with as many fragments lost as
+    // possible, gives back the encoded fragment and its properties.
+    void run_test_repair(fec::FecType type)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        const size_t block_size = (10 * pkt_size + 5) * word_size;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+
+        const unsigned n_outputs = fec.n_outputs;
+        const bool systematic = type == fec::FecType::SYSTEMATIC;
+
+        std::vector<std::vector<uint8_t>> data(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(this->n_data);
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            parities_bufs[i] = parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+        const unsigned code_len = fec.code_len;
+        std::vector<uint8_t> output(block_size);
+        quadiron::Properties output_props;
+        for (unsigned dest = 0; dest < code_len; ++dest) {
+            // Lose `dest` and the fragments following it.
+            std::vector<int> missing_idxs(code_len, 0);
+            for (unsigned i = 0; i < code_len - this->n_data; ++i) {
+                missing_idxs[(dest + i) % code_len] = 1;
+            }
+
+            ASSERT_TRUE(fec.repair_block_vertical(
+                dest,
+                data_bufs,
+                parities_bufs,
+                props,
+                missing_idxs,
+                output.data(),
+                output_props,
+                block_size));
+
+            if (systematic && dest < this->n_data) {
+                ASSERT_EQ(output, data[dest]);
+                ASSERT_TRUE(output_props.get_map().empty());
+            } else {
+                const unsigned i = systematic ? dest - this->n_data : dest;
+                ASSERT_EQ(output, parities[i]);
+                ASSERT_EQ(output_props.get_map(), props[i].get_map());
+            }
+        }
+
+        // Not enough fragments
+        std::vector<int> missing_idxs(code_len, 1);
+        ASSERT_FALSE(fec.repair_block_vertical(
+            0,
+            data_bufs,
+            parities_bufs,
+            props,
+            missing_idxs,
+            output.data(),
+            output_props,
+            block_size));
+    }
+
+    // Check that encoding a single output gives the same output and
+    // properties as the full encoding.
+    void run_test_pruned_encode(fec::FecType type)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t pkt_size = 64;
+        const size_t block_size = (10 * pkt_size + 5) * word_size;
+
+        fec::RsFnt<T> fec(
+            type, word_size, this->n_data, this->n_parities, pkt_size);
+
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::vector<uint8_t>> data(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> ref_parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(this->n_data);
+        std::vector<uint8_t*> ref_parities_bufs(n_outputs);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            ref_parities_bufs[i] = ref_parities[i].data();
+        }
+        std::vector<quadiron::Properties> ref_props(n_outputs);
+        std::vector<bool> all_idxs(n_outputs, true);
+
+        fec.encode_blocks_vertical(
+            data_bufs, ref_parities_bufs, ref_props, all_idxs, block_size);
+
+        for (unsigned wanted = 0; wanted < n_outputs; ++wanted) {
+            std::vector<uint8_t> parity(block_size);
+            std::vector<uint8_t*> parities_bufs(n_outputs, nullptr);
+            parities_bufs[wanted] = parity.data();
+            std::vector<quadiron::Properties> props(n_outputs);
+            std::vector<bool> wanted_idxs(n_outputs, false);
+            wanted_idxs[wanted] = true;
+
+            fec.encode_blocks_vertical(
+                data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+            ASSERT_EQ(parity, ref_parities[wanted]);
+            ASSERT_EQ(props[wanted].get_map(), ref_props[wanted].get_map());
+        }
+    }
 };
 
 using FntType = ::testing::Types<uint16_t, uint32_t>;
@@ -155,8 +837,127 @@ TYPED_TEST(FecTestFnt, TestFntSys) // NOLINT
     this->run_test(fec, true);
 }
 
+TYPED_TEST(FecTestFnt, TestFntBlocksParallel) // NOLINT
+{
+    for (unsigned n_threads = 2; n_threads <= 4; ++n_threads) {
+        this->run_test_blocks_parallel(
+            fec::FecType::NON_SYSTEMATIC, n_threads);
+        this->run_test_blocks_parallel(fec::FecType::SYSTEMATIC, n_threads);
+    }
+}
+
+TYPED_TEST(FecTestFnt, TestFntEncodeStripes) // NOLINT
+{
+    for (unsigned n_threads = 1; n_threads <= 3; ++n_threads) {
+        this->run_test_encode_stripes(fec::FecType::NON_SYSTEMATIC, n_threads);
+        this->run_test_encode_stripes(fec::FecType::SYSTEMATIC, n_threads);
+    }
+}
+
+TYPED_TEST(FecTestFnt, TestFntStreamsPipelined) // NOLINT
+{
+    this->run_test_streams_pipelined(fec::FecType::NON_SYSTEMATIC);
+    this->run_test_streams_pipelined(fec::FecType::SYSTEMATIC);
+}
+
+TYPED_TEST(FecTestFnt, TestFntDecodeCache) // NOLINT
+{
+    this->run_test_decode_cache(fec::FecType::NON_SYSTEMATIC);
+    this->run_test_decode_cache(fec::FecType::SYSTEMATIC);
+}
+
+TYPED_TEST(FecTestFnt, TestFntStageStats) // NOLINT
+{
+    this->run_test_stage_stats(fec::FecType::NON_SYSTEMATIC);
+    this->run_test_stage_stats(fec::FecType::SYSTEMATIC);
+}
+
+TYPED_TEST(FecTestFnt, TestFntUpdateParities) // NOLINT
+{
+    this->run_test_update_parities(fec::FecType::NON_SYSTEMATIC);
+    this->run_test_update_parities(fec::FecType::SYSTEMATIC);
+}
+
+TYPED_TEST(FecTestFnt, TestFntRepair) // NOLINT
+{
+    this->run_test_repair(fec::FecType::NON_SYSTEMATIC);
+    this->run_test_repair(fec::FecType::SYSTEMATIC);
+}
+
+TYPED_TEST(FecTestFnt, TestFntPrunedEncode) // NOLINT
+{
+    this->run_test_pruned_encode(fec::FecType::NON_SYSTEMATIC);
+    this->run_test_pruned_encode(fec::FecType::SYSTEMATIC);
+}
+
 template <typename T>
 class FecTestNo128 : public FecTestCommon<T> {
+  public:
+    // Check that the blocks encoded by the Buffers-based `encode` are decoded
+    // back by the Buffers-based `decode`, for all the patterns of `n_lost`
+    // consecutive lost fragments (`n_outputs` if 0).
+    void run_test_blocks_vertical(
+        fec::FecCode<T>& fec,
+        size_t block_size,
+        unsigned n_lost = 0)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::vector<uint8_t>> data(
+            this->n_data, std::vector<uint8_t>(block_size));
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(this->n_data);
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (auto& byte : data[i]) {
+                byte = static_cast<uint8_t>(rand());
+            }
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            parities_bufs[i] = parities[i].data();
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+        const unsigned n_frags = this->n_data + n_outputs;
+        if (n_lost == 0) {
+            n_lost = n_outputs;
+        }
+
+        // Lose the fragments in `[first_missing, first_missing + n_lost)`.
+        for (unsigned first_missing = 0; first_missing + n_lost <= n_frags;
+             ++first_missing) {
+            std::vector<int> missing_idxs(n_frags, 0);
+            std::fill_n(missing_idxs.begin() + first_missing, n_lost, 1);
+
+            std::vector<std::vector<uint8_t>> decoded(
+                this->n_data, std::vector<uint8_t>(block_size));
+            std::vector<uint8_t*> decoded_bufs(this->n_data);
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                if (!missing_idxs[i]) {
+                    decoded[i] = data[i];
+                }
+                decoded_bufs[i] = decoded[i].data();
+            }
+            std::vector<bool> wanted_data_idxs(this->n_data, true);
+
+            ASSERT_TRUE(fec.decode_blocks_vertical(
+                decoded_bufs,
+                parities_bufs,
+                props,
+                missing_idxs,
+                wanted_data_idxs,
+                block_size));
+            for (unsigned i = 0; i < this->n_data; ++i) {
+                ASSERT_EQ(data[i], decoded[i]);
+            }
+        }
+    }
 };
 
 using No128 = ::testing::Types<uint16_t, uint32_t, uint64_t>;
@@ -168,3 +969,59 @@ TYPED_TEST(FecTestNo128, TestGfpFft) // NOLINT
     fec::RsGfpFft<TypeParam> fec(word_size, this->n_data, this->n_parities);
     this->run_test(fec, true);
 }
+
+TYPED_TEST(FecTestNo128, TestGf2nBlocksVertical) // NOLINT
+{
+    const size_t pkt_size = 64;
+    const fec::RsMatrixType types[] = {fec::RsMatrixType::VANDERMONDE,
+                                       fec::RsMatrixType::CAUCHY};
+
+    for (size_t word_size = 1; word_size <= sizeof(TypeParam) / 2;
+         word_size *= 2) {
+        // The last packet of the blocks is incomplete.
+        const size_t block_size = (10 * pkt_size + 5) * word_size;
+        for (const fec::RsMatrixType type : types) {
+            fec::RsGf2n<TypeParam> fec(
+                word_size, this->n_data, this->n_parities, type, pkt_size);
+            this->run_test_blocks_vertical(fec, block_size);
+        }
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestGf2nDecodeMatrixCache) // NOLINT
+{
+    const size_t pkt_size = 16;
+    const size_t word_size = 1;
+    const size_t block_size = 3 * pkt_size;
+
+    fec::RsGf2n<TypeParam> fec(
+        word_size,
+        this->n_data,
+        this->n_parities,
+        fec::RsMatrixType::CAUCHY,
+        pkt_size);
+    ASSERT_EQ(
+        fec.get_decode_matrix_capacity(),
+        fec::RsGf2n<TypeParam>::DEFAULT_DECODE_MATRIX_CAPACITY);
+
+    // Three of the four patterns of three lost fragments lose data.
+    this->run_test_blocks_vertical(fec, block_size);
+    ASSERT_EQ(fec.get_decode_matrix_hits(), 0);
+    ASSERT_EQ(fec.get_decode_matrix_misses(), 3);
+    this->run_test_blocks_vertical(fec, block_size);
+    ASSERT_EQ(fec.get_decode_matrix_hits(), 3);
+    ASSERT_EQ(fec.get_decode_matrix_misses(), 3);
+
+    // Patterns evict each other.
+    fec.set_decode_matrix_capacity(1);
+    this->run_test_blocks_vertical(fec, block_size);
+    ASSERT_EQ(fec.get_decode_matrix_hits(), 3);
+    ASSERT_EQ(fec.get_decode_matrix_misses(), 6);
+
+    // Patterns of one and two lost fragments are all precomputed.
+    fec.precompute_decode_matrices();
+    this->run_test_blocks_vertical(fec, block_size, 1);
+    this->run_test_blocks_vertical(fec, block_size, 2);
+    ASSERT_EQ(fec.get_decode_matrix_hits(), 9);
+    ASSERT_EQ(fec.get_decode_matrix_misses(), 6);
+}
@@ -27,6 +27,9 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+#include <numeric>
+
 #include <gtest/gtest.h>
 
 #include "fft_2n.h"
@@ -39,6 +42,7 @@
 #include "gf_bin_ext.h"
 #include "gf_prime.h"
 #include "misc.h"
+#include "thread_pool.h"
 #include "vec_poly.h"
 
 namespace fft = quadiron::fft;
@@ -420,6 +424,90 @@ TYPED_TEST(FftTest, TestNaiveVsFft2kVecp) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestFft2kPruned) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const size_t size = 4;
+
+    for (auto const& code_len : this->code_lengths) {
+        const unsigned n = gf.get_code_len(code_len);
+
+        for (unsigned data_len = 2; data_len <= n; data_len *= 2) {
+            fft::Radix2<TypeParam> fft(gf, n, data_len, size);
+
+            vec::Buffers<TypeParam> v(data_len, size);
+            vec::Buffers<TypeParam> full(n, size);
+            vec::Buffers<TypeParam> pruned(n, size);
+            for (int j = 0; j < 10; j++) {
+                for (unsigned i = 0; i < data_len; i++) {
+                    TypeParam* mem = v.get(i);
+                    for (size_t u = 0; u < size; u++) {
+                        mem[u] = gf.rand();
+                    }
+                }
+                // A few outputs, possibly sharing residues modulo the layers
+                std::vector<unsigned> outputs;
+                for (unsigned i = 0; i <= static_cast<unsigned>(j % 3); i++) {
+                    outputs.push_back(gf.rand() % n);
+                }
+
+                fft.fft(full, v);
+                fft.fft_pruned(pruned, v, outputs);
+
+                for (const unsigned k : outputs) {
+                    ASSERT_TRUE(std::equal(
+                        full.get(k), full.get(k) + size, pruned.get(k)));
+                }
+            }
+
+            std::vector<unsigned> all_outputs(n);
+            std::iota(all_outputs.begin(), all_outputs.end(), 0);
+            ASSERT_FALSE(fft.is_pruning_worth(data_len, all_outputs));
+            if (n / data_len >= 2 && n >= 8) {
+                ASSERT_TRUE(fft.is_pruning_worth(data_len, {n - 1}));
+            }
+        }
+    }
+}
+
+TYPED_TEST(FftTest, TestFft2kBlocked) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    const unsigned n = 256;
+    // Large enough to perform the layers by blocks of 32 buffers.
+    const size_t size =
+        quadiron::fft::FFT_BLOCK_BYTES / 64 / sizeof(TypeParam) + 3;
+
+    for (unsigned data_len = 8; data_len <= n; data_len *= 2) {
+        fft::Radix2<TypeParam> fft(gf, n, data_len, size);
+
+        vec::Buffers<TypeParam> v(data_len, size);
+        vec::Buffers<TypeParam> v2(n, size);
+        vec::Buffers<TypeParam> _v2(n, size);
+        for (unsigned i = 0; i < data_len; i++) {
+            TypeParam* mem = v.get(i);
+            for (size_t u = 0; u < size; u++) {
+                mem[u] = gf.rand();
+            }
+        }
+        fft.fft(v2, v);
+        fft.ifft(_v2, v2);
+
+        vec::Vector<TypeParam> col(gf, data_len);
+        vec::Vector<TypeParam> col2(gf, n);
+        for (size_t u = 0; u < size; u += 7) {
+            for (unsigned i = 0; i < data_len; i++) {
+                col.set(i, v.get(i)[u]);
+            }
+            fft.fft(col2, col);
+            for (unsigned i = 0; i < n; i++) {
+                ASSERT_EQ(v2.get(i)[u], col2.get(i));
+                ASSERT_EQ(_v2.get(i)[u], i < data_len ? col.get(i) : 0);
+            }
+        }
+    }
+}
+
 TYPED_TEST(FftTest, TestFftGt) // NOLINT
 {
     auto gf(gf::create<gf::BinExtension<TypeParam>>(16));
@@ -435,6 +523,59 @@ TYPED_TEST(FftTest, TestFftGt) // NOLINT
     }
 }
 
+// Compare the Buffers versions of a decomposed FFT to its Vector version,
+// with the sub-transforms run sequentially, then on `pool`.
+template <typename T, typename Fft>
+void test_fft_buffers_decomposed(
+    const gf::Field<T>& gf,
+    const std::vector<unsigned>& code_lengths,
+    quadiron::ThreadPool* pool)
+{
+    const size_t size = 7;
+
+    for (auto const& code_len : code_lengths) {
+        const T n = gf.get_code_len(code_len);
+        Fft fft(gf, n, 0, nullptr, 0, size);
+        fft.set_thread_pool(pool);
+
+        vec::Buffers<T> v(n, size);
+        vec::Buffers<T> values(n, size);
+        vec::Buffers<T> v2(n, size);
+        for (unsigned i = 0; i < n; i++) {
+            for (size_t u = 0; u < size; u++) {
+                v.get(i)[u] = gf.rand();
+            }
+        }
+
+        fft.fft(values, v);
+        fft.ifft(v2, values);
+        ASSERT_EQ(v2, v);
+
+        vec::Vector<T> _v(gf, n);
+        vec::Vector<T> _values(gf, n);
+        for (size_t u = 0; u < size; u++) {
+            for (unsigned i = 0; i < n; i++) {
+                _v.set(i, v.get(i)[u]);
+            }
+            fft.fft(_values, _v);
+            for (unsigned i = 0; i < n; i++) {
+                ASSERT_EQ(values.get(i)[u], _values.get(i));
+            }
+        }
+    }
+}
+
+TYPED_TEST(FftTest, TestFftGtBuffers) // NOLINT
+{
+    auto gf(gf::create<gf::BinExtension<TypeParam>>(16));
+    quadiron::ThreadPool pool(2);
+
+    test_fft_buffers_decomposed<TypeParam, fft::GoodThomas<TypeParam>>(
+        gf, this->code_lengths, nullptr);
+    test_fft_buffers_decomposed<TypeParam, fft::GoodThomas<TypeParam>>(
+        gf, this->code_lengths, &pool);
+}
+
 TYPED_TEST(FftTest, TestFftCtGfp) // NOLINT
 {
     auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
@@ -450,6 +591,17 @@ TYPED_TEST(FftTest, TestFftCtGfp) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestFftCtBuffers) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    quadiron::ThreadPool pool(2);
+
+    test_fft_buffers_decomposed<TypeParam, fft::CooleyTukey<TypeParam>>(
+        gf, this->code_lengths, nullptr);
+    test_fft_buffers_decomposed<TypeParam, fft::CooleyTukey<TypeParam>>(
+        gf, this->code_lengths, &pool);
+}
+
 TYPED_TEST(FftTest, TestFftCtGf2n) // NOLINT
 {
     const size_t max_n = 8 * sizeof(TypeParam);
@@ -497,6 +649,78 @@ TYPED_TEST(FftTest, TestFftAdd) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestFftAddBuffers) // NOLINT
+{
+    // Not a multiple of any register size to have trailing elements.
+    const size_t size = 37;
+
+    for (size_t gf_n = 8; gf_n <= 8 * sizeof(TypeParam); gf_n *= 2) {
+        auto gf(gf::create<gf::BinExtension<TypeParam>>(gf_n));
+
+        for (auto const& code_len : this->code_lengths) {
+            const int n = arith::ceil2<TypeParam>(code_len);
+            const int m = arith::log2<TypeParam>(n);
+            fft::Additive<TypeParam> fft(gf, m);
+
+            // Zero-extended input of `code_len / 2 + 1` polynomials.
+            const int len = code_len / 2 + 1;
+            vec::Buffers<TypeParam> v(len, size);
+            for (int i = 0; i < len; i++) {
+                for (size_t u = 0; u < size; u++) {
+                    v.get(i)[u] = gf.rand();
+                }
+            }
+            vec::Buffers<TypeParam> values(n, size);
+            vec::Buffers<TypeParam> coefs(n, size);
+            fft.fft(values, v);
+            fft.ifft(coefs, values);
+
+            vec::Vector<TypeParam> _v(gf, n);
+            vec::Vector<TypeParam> _values(gf, n);
+            for (size_t u = 0; u < size; u++) {
+                _v.zero_fill();
+                for (int i = 0; i < len; i++) {
+                    _v.set(i, v.get(i)[u]);
+                }
+                fft.fft(_values, _v);
+                for (int i = 0; i < n; i++) {
+                    ASSERT_EQ(values.get(i)[u], _values.get(i));
+                    ASSERT_EQ(coefs.get(i)[u], _v.get(i));
+                }
+            }
+
+            // Taylor expansion on (x^t - x).
+            for (auto const& t : this->vec_t) {
+                const int n_taylor = std::min(t + 10, n);
+                const int n_hi = (n_taylor + t - 1) / t * t;
+                vec::Buffers<TypeParam> f(n_taylor, size);
+                vec::Buffers<TypeParam> full(n_taylor, size);
+                for (int i = 0; i < n_taylor; i++) {
+                    for (size_t u = 0; u < size; u++) {
+                        full.get(i)[u] = gf.rand();
+                    }
+                }
+                vec::Buffers<TypeParam> h(n_hi, size);
+                fft.taylor_expand(h, full, n_taylor, t);
+                fft.inv_taylor_expand(f, h, t);
+                ASSERT_EQ(f, full);
+
+                vec::Vector<TypeParam> _f(gf, n_taylor);
+                vec::Vector<TypeParam> _h(gf, n_hi);
+                for (size_t u = 0; u < size; u++) {
+                    for (int i = 0; i < n_taylor; i++) {
+                        _f.set(i, full.get(i)[u]);
+                    }
+                    fft.taylor_expand(_h, _f, n_taylor, t);
+                    for (int i = 0; i < n_hi; i++) {
+                        ASSERT_EQ(h.get(i)[u], _h.get(i));
+                    }
+                }
+            }
+        }
+    }
+}
+
 TYPED_TEST(FftTest, TestFftNaive2) // NOLINT
 {
     auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
@@ -612,6 +836,46 @@ TYPED_TEST(FftTest, TestFftLarge) // NOLINT
     ASSERT_EQ(*_a1 == *_a2, true);
 }
 
+TYPED_TEST(FftTest, TestFftLargeBuffers) // NOLINT
+{
+    const unsigned q = 7681;
+    const size_t size = 5;
+    auto gf(gf::create<gf::Prime<TypeParam>>(q));
+
+    for (const unsigned n : {2, 4, 256}) {
+        const TypeParam r = gf.get_nth_root(n);
+        const int l = arith::log2<TypeParam>(n);
+        fft::Large<TypeParam> fft(gf, l, r);
+
+        vec::Buffers<TypeParam> v(n, size);
+        vec::Buffers<TypeParam> values(n, size);
+        vec::Buffers<TypeParam> v2(n, size);
+        for (unsigned i = 0; i < n; i++) {
+            for (size_t u = 0; u < size; u++) {
+                v.get(i)[u] = gf.rand();
+            }
+        }
+        // Overflow case of the modular operations.
+        v.get(n - 1)[size - 1] = q - 1;
+
+        fft.fft(values, v);
+        fft.ifft(v2, values);
+        ASSERT_EQ(v2, v);
+
+        vec::Vector<TypeParam> _v(gf, n);
+        vec::Vector<TypeParam> _values(gf, n);
+        for (size_t u = 0; u < size; u++) {
+            for (unsigned i = 0; i < n; i++) {
+                _v.set(i, v.get(i)[u]);
+            }
+            fft.fft(_values, _v);
+            for (unsigned i = 0; i < n; i++) {
+                ASSERT_EQ(values.get(i)[u], _values.get(i));
+            }
+        }
+    }
+}
+
 TYPED_TEST(FftTest, TestFftEquivalence) // NOLINT
 {
     std::vector<uint64_t> qs({7681, 12289, 65537});
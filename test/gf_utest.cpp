@@ -33,6 +33,7 @@
 #include "gf_nf4.h"
 
 namespace gf = quadiron::gf;
+namespace vec = quadiron::vec;
 
 template <typename T>
 class GfTestCommon : public ::testing::Test {
@@ -164,6 +165,28 @@ TYPED_TEST(GfTestCommon, TestGfNf4) // NOLINT
             const TypeParam y = gf.pack(z.values, z.flag);
             ASSERT_EQ(x, y);
         }
+
+        // Test the planar layout.
+        const size_t len = 33;
+        std::vector<TypeParam> values(len);
+        std::vector<TypeParam> merged(len);
+        std::vector<std::vector<uint32_t>> lanes(n, std::vector<uint32_t>(len));
+        std::vector<uint32_t*> lanes_ptrs(n);
+        for (unsigned i = 0; i < n; i++) {
+            lanes_ptrs[i] = lanes[i].data();
+        }
+        for (size_t j = 0; j < len; j++) {
+            values[j] = gf.unpacked_rand();
+        }
+        gf.split_lanes(values.data(), lanes_ptrs.data(), len);
+        for (size_t j = 0; j < len; j++) {
+            const TypeParam packed = gf.pack(values[j]);
+            for (unsigned i = 0; i < n; i++) {
+                ASSERT_EQ(lanes[i][j], static_cast<uint32_t>(packed >> 32 * i));
+            }
+        }
+        gf.merge_lanes(lanes_ptrs.data(), merged.data(), len);
+        ASSERT_EQ(merged, values);
     }
 }
 
@@ -204,6 +227,33 @@ TYPED_TEST(GfTestNo128, TestGf5) // NOLINT
     this->test_find_primitive_root(&gf);
 }
 
+TYPED_TEST(GfTestNo128, TestMulCoefToBuf) // NOLINT
+{
+    std::vector<TypeParam> cards = {257, 12289, 65537, 2147483647};
+    if (sizeof(TypeParam) >= sizeof(uint64_t)) {
+        cards.push_back(static_cast<TypeParam>(4294991873ULL));
+    }
+    // Not a multiple of any register size to have trailing elements.
+    const size_t len = 67;
+
+    for (const TypeParam card : cards) {
+        auto gf(gf::create<gf::Prime<TypeParam>>(card));
+        vec::Buffers<TypeParam> src(1, len);
+        vec::Buffers<TypeParam> dest(1, len);
+        for (size_t i = 0; i < len; i++) {
+            src.get(0)[i] = gf.rand();
+        }
+        src.get(0)[len - 1] = card - 1;
+
+        for (const TypeParam a : {static_cast<TypeParam>(2), card - 2}) {
+            gf.mul_coef_to_buf(a, src.get(0), dest.get(0), len);
+            for (size_t i = 0; i < len; i++) {
+                ASSERT_EQ(dest.get(0)[i], gf.mul(a, src.get(0)[i]));
+            }
+        }
+    }
+}
+
 TYPED_TEST(GfTestNo128, TestGf256) // NOLINT
 {
     quadiron::prng().seed(time(0));
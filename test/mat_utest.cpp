@@ -89,3 +89,44 @@ TEST(MatrixTest, TestInvertGf29) // NOLINT
     ASSERT_EQ(mat.get(2, 1), 24);
     ASSERT_EQ(mat.get(2, 2), 14);
 }
+
+TEST(MatrixTest, TestMulBuffersGf2n) // NOLINT
+{
+    const size_t size = 37;
+
+    for (unsigned n = 8; n <= 16; n += 8) {
+        const auto gf(gf::create<gf::BinExtension<uint32_t>>(n));
+        vec::Matrix<uint32_t> mat(gf, 3, 4);
+        mat.cauchy();
+        // Exercise the shortcuts taken for the coefficients 0 and 1.
+        mat.set(0, 0, 0);
+        mat.set(1, 0, 1);
+        mat.set(1, 2, 1);
+        for (int j = 0; j < 4; j++) {
+            mat.set(2, j, 0);
+        }
+
+        vec::Buffers<uint32_t> input(4, size);
+        vec::Buffers<uint32_t> output(3, size);
+        for (int j = 0; j < 4; j++) {
+            for (size_t k = 0; k < size; k++) {
+                input.get(j)[k] = gf.rand();
+            }
+        }
+        output.fill(2, 1);
+
+        mat.mul(&output, &input);
+
+        vec::Vector<uint32_t> v(gf, 4);
+        vec::Vector<uint32_t> expected(gf, 3);
+        for (size_t k = 0; k < size; k++) {
+            for (int j = 0; j < 4; j++) {
+                v.set(j, input.get(j)[k]);
+            }
+            mat.mul(&expected, &v);
+            for (int i = 0; i < 3; i++) {
+                ASSERT_EQ(output.get(i)[k], expected.get(i));
+            }
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "property.h"
+
+using quadiron::OOR_MARK;
+using quadiron::Properties;
+
+class PropertyTest : public ::testing::Test {
+  public:
+    /** Return properties marking sorted locations */
+    Properties make_props(const std::vector<size_t>& locations)
+    {
+        Properties props;
+        for (const size_t loc : locations) {
+            props.add(loc, OOR_MARK);
+        }
+        return props;
+    }
+};
+
+TEST_F(PropertyTest, TestMarkers) // NOLINT
+{
+    Properties props = make_props({10, 20});
+    ASSERT_EQ(props.marker(0), OOR_MARK);
+    ASSERT_EQ(props.marker(2), 0);
+
+    props.add(5, 42);
+    props.sort();
+    ASSERT_EQ(props.size(), 3);
+    ASSERT_EQ(props.location(0), 5);
+    ASSERT_EQ(props.marker(0), 42);
+    ASSERT_EQ(props.marker(1), OOR_MARK);
+    ASSERT_EQ(props.lower_bound(11), 2);
+
+    Properties other = make_props({30});
+    other.append(props);
+    const std::vector<std::pair<size_t, uint32_t>> expected = {
+        {30, OOR_MARK}, {5, 42}, {10, OOR_MARK}, {20, OOR_MARK}};
+    ASSERT_EQ(other.get_map(), expected);
+}
+
+TEST_F(PropertyTest, TestFirstMarker) // NOLINT
+{
+    Properties props;
+    props.add(7, 3);
+    props.add(9, OOR_MARK);
+    ASSERT_EQ(props.marker(0), 3);
+    ASSERT_EQ(props.marker(1), OOR_MARK);
+
+    Properties other;
+    other.append(props);
+    ASSERT_EQ(other.get_map(), props.get_map());
+}
+
+TEST_F(PropertyTest, TestSerialize) // NOLINT
+{
+    const std::vector<size_t> locations = {0, 1, 127, 128, 65537, 4000000};
+    const Properties props = make_props(locations);
+
+    for (const uint32_t format : {Properties::FNT1, Properties::FNT2}) {
+        std::vector<uint32_t> dwords(16);
+        Properties copy = props;
+        ASSERT_EQ(copy.fnt_serialize(dwords.data(), dwords.size(), format), 0);
+
+        Properties result;
+        ASSERT_EQ(result.fnt_deserialize(dwords.data(), dwords.size()), 0);
+        ASSERT_EQ(result.get_map(), props.get_map());
+
+        // Too small buffer.
+        ASSERT_EQ(copy.fnt_serialize(dwords.data(), 3, format), -1);
+    }
+}
+
+TEST_F(PropertyTest, TestCompactSize) // NOLINT
+{
+    std::vector<size_t> locations;
+    for (size_t loc = 70000; loc < 70000 * 100; loc += 65537) {
+        locations.push_back(loc);
+    }
+    Properties props = make_props(locations);
+
+    // 3 bytes per location, plus the header.
+    const unsigned n_dwords = 2 + (3 * locations.size() + 3) / 4;
+    std::vector<uint32_t> dwords(n_dwords);
+    ASSERT_EQ(
+        props.fnt_serialize(dwords.data(), n_dwords, Properties::FNT1), -1);
+    ASSERT_EQ(
+        props.fnt_serialize(dwords.data(), n_dwords, Properties::FNT2), 0);
+
+    Properties result;
+    ASSERT_EQ(result.fnt_deserialize(dwords.data(), n_dwords), 0);
+    ASSERT_EQ(result.get_map(), props.get_map());
+
+    // A truncated buffer is rejected.
+    Properties truncated;
+    ASSERT_EQ(truncated.fnt_deserialize(dwords.data(), n_dwords - 1), -1);
+}
@@ -105,16 +105,20 @@ class QuadironCTest : public ::testing::Test {
      * @param missing_idxs vector of boolean vales indicating missing fragments
      * for decode and reconstruct
      *        - must be of length n_parities
+     * @param shared_inst a FEC instance to reuse, a new one is created if null
      */
     void test_encode_decode_reconstruct(
         int n_data,
         int n_parities,
         size_t block_size,
         int systematic,
-        std::vector<int> missing_idxs)
+        std::vector<int> missing_idxs,
+        struct QuadironFnt32* shared_inst = nullptr)
     {
-        struct QuadironFnt32* inst =
-            quadiron_fnt32_new(2, n_data, n_parities, systematic);
+        struct QuadironFnt32* inst = shared_inst;
+        if (!inst) {
+            inst = quadiron_fnt32_new(2, n_data, n_parities, systematic);
+        }
         size_t metadata_size =
             quadiron_fnt32_get_metadata_size(inst, block_size);
         std::vector<std::vector<uint8_t>> data(n_data);
@@ -277,10 +281,17 @@ class QuadironCTest : public ::testing::Test {
             }
         }
 
-        quadiron_fnt32_delete(inst);
+        if (!shared_inst) {
+            quadiron_fnt32_delete(inst);
+        }
     }
 
-    void test_all_decodable_scenarios(int k, int m, int systematic)
+    void test_all_decodable_scenarios(
+        int k,
+        int m,
+        int systematic,
+        struct QuadironFnt32* shared_inst = nullptr,
+        size_t block_size = 10000)
     {
         for (int i = 0; i <= m; i++) {
             const auto combinations = generate_combinations(k + m, i);
@@ -289,8 +300,187 @@ class QuadironCTest : public ::testing::Test {
                 std::vector<int> missing_idxs(k + m);
                 convert_idx_list(*it, i, missing_idxs, k + m);
                 test_encode_decode_reconstruct(
-                    k, m, 10000, systematic, missing_idxs);
+                    k, m, block_size, systematic, missing_idxs, shared_inst);
+            }
+        }
+    }
+
+    /** Run all scenarios on a single instance, whose scratch is reused */
+    void test_reused_instance(int k, int m, int systematic)
+    {
+        struct QuadironFnt32* inst = quadiron_fnt32_new(2, k, m, systematic);
+
+        const std::vector<size_t> block_sizes = {10000, 4096, 20000};
+        for (size_t block_size : block_sizes) {
+            test_all_decodable_scenarios(k, m, systematic, inst, block_size);
+        }
+
+        quadiron_fnt32_delete(inst);
+    }
+
+    /** Check that encoding a batch of stripes gives the same fragments as
+     * encoding each stripe on its own.
+     */
+    void test_encode_batch(int n_data, int n_parities, int systematic)
+    {
+        const size_t n_stripes = 4;
+        const size_t block_size = 8192;
+        struct QuadironFnt32* inst =
+            quadiron_fnt32_new(2, n_data, n_parities, systematic);
+        const size_t full_block_size =
+            block_size + quadiron_fnt32_get_metadata_size(inst, block_size);
+        const int n_outputs = systematic ? n_parities : n_data + n_parities;
+        std::vector<int> wanted_idxs(n_outputs, 1);
+
+        using Blocks = std::vector<std::vector<uint8_t>>;
+        std::vector<Blocks> data(n_stripes, Blocks(n_data));
+        std::vector<Blocks> ref_data(n_stripes, Blocks(n_data));
+        std::vector<Blocks> parity(n_stripes, Blocks(n_parities));
+        std::vector<Blocks> ref_parity(n_stripes, Blocks(n_parities));
+        std::vector<std::vector<uint8_t*>> _data(n_stripes);
+        std::vector<std::vector<uint8_t*>> _parity(n_stripes);
+        std::vector<uint8_t**> _data_stripes(n_stripes);
+        std::vector<uint8_t**> _parity_stripes(n_stripes);
+
+        for (size_t s = 0; s < n_stripes; s++) {
+            for (int i = 0; i < n_data; i++) {
+                data[s][i].resize(full_block_size);
+                randomize_buffer(data[s][i].data(), full_block_size);
+                ref_data[s][i] = data[s][i];
+                _data[s].push_back(data[s][i].data());
+            }
+            for (int i = 0; i < n_parities; i++) {
+                parity[s][i].resize(full_block_size);
+                ref_parity[s][i].resize(full_block_size);
+                _parity[s].push_back(parity[s][i].data());
+            }
+            _data_stripes[s] = _data[s].data();
+            _parity_stripes[s] = _parity[s].data();
+        }
+
+        ASSERT_EQ(
+            quadiron_fnt32_encode_batch(
+                inst,
+                _data_stripes.data(),
+                _parity_stripes.data(),
+                wanted_idxs.data(),
+                n_stripes,
+                block_size),
+            0);
+
+        for (size_t s = 0; s < n_stripes; s++) {
+            std::vector<uint8_t*> _ref_data(n_data);
+            std::vector<uint8_t*> _ref_parity(n_parities);
+            for (int i = 0; i < n_data; i++) {
+                _ref_data[i] = ref_data[s][i].data();
             }
+            for (int i = 0; i < n_parities; i++) {
+                _ref_parity[i] = ref_parity[s][i].data();
+            }
+            ASSERT_EQ(
+                quadiron_fnt32_encode(
+                    inst,
+                    _ref_data.data(),
+                    _ref_parity.data(),
+                    wanted_idxs.data(),
+                    block_size),
+                0);
+
+            ASSERT_EQ(data[s], ref_data[s]);
+            ASSERT_EQ(parity[s], ref_parity[s]);
+        }
+
+        quadiron_fnt32_delete(inst);
+    }
+
+    void test_update(
+        int n_data,
+        int n_parities,
+        int systematic,
+        struct QuadironFnt32* shared_inst = nullptr)
+    {
+        const size_t block_size = 8192;
+        struct QuadironFnt32* inst = shared_inst;
+        if (!inst) {
+            inst = quadiron_fnt32_new(2, n_data, n_parities, systematic);
+        }
+        const int metadata_size =
+            quadiron_fnt32_get_metadata_size(inst, block_size);
+        const size_t full_block_size = block_size + metadata_size;
+        const int n_outputs = systematic ? n_parities : n_data + n_parities;
+        const int data_idx = n_data - 1;
+        std::vector<int> wanted_idxs(n_outputs, 1);
+
+        using Blocks = std::vector<std::vector<uint8_t>>;
+        Blocks data(n_data, std::vector<uint8_t>(full_block_size));
+        Blocks parity(n_parities, std::vector<uint8_t>(full_block_size));
+        std::vector<uint8_t*> _data(n_data);
+        std::vector<uint8_t*> _parity(n_parities);
+        for (int i = 0; i < n_data; i++) {
+            randomize_buffer(data[i].data(), full_block_size);
+            _data[i] = data[i].data();
+        }
+        for (int i = 0; i < n_parities; i++) {
+            _parity[i] = parity[i].data();
+        }
+        Blocks ref_data = data;
+        Blocks ref_parity = parity;
+
+        const std::vector<uint8_t> old_payload(
+            data[data_idx].begin() + metadata_size, data[data_idx].end());
+        std::vector<uint8_t> new_payload(block_size);
+        randomize_buffer(new_payload.data(), block_size);
+        std::copy(
+            new_payload.begin(),
+            new_payload.end(),
+            ref_data[data_idx].begin() + metadata_size);
+
+        ASSERT_EQ(
+            quadiron_fnt32_encode(
+                inst,
+                _data.data(),
+                _parity.data(),
+                wanted_idxs.data(),
+                block_size),
+            0);
+        if (systematic) {
+            std::copy(
+                new_payload.begin(),
+                new_payload.end(),
+                data[data_idx].begin() + metadata_size);
+        }
+        ASSERT_EQ(
+            quadiron_fnt32_update(
+                inst,
+                data_idx,
+                old_payload.data(),
+                new_payload.data(),
+                _data.data(),
+                _parity.data(),
+                wanted_idxs.data(),
+                block_size),
+            0);
+
+        for (int i = 0; i < n_data; i++) {
+            _data[i] = ref_data[i].data();
+        }
+        for (int i = 0; i < n_parities; i++) {
+            _parity[i] = ref_parity[i].data();
+        }
+        ASSERT_EQ(
+            quadiron_fnt32_encode(
+                inst,
+                _data.data(),
+                _parity.data(),
+                wanted_idxs.data(),
+                block_size),
+            0);
+
+        ASSERT_EQ(data, ref_data);
+        ASSERT_EQ(parity, ref_parity);
+
+        if (!shared_inst) {
+            quadiron_fnt32_delete(inst);
         }
     }
 };
@@ -307,3 +497,136 @@ TYPED_TEST(QuadironCTest, TestBasicNSys) // NOLINT
 {
     this->test_all_decodable_scenarios(3, 3, 0);
 }
+
+TYPED_TEST(QuadironCTest, TestReusedInstanceSys) // NOLINT
+{
+    this->test_reused_instance(3, 3, 1);
+}
+
+TYPED_TEST(QuadironCTest, TestReusedInstanceNSys) // NOLINT
+{
+    this->test_reused_instance(3, 3, 0);
+}
+
+TYPED_TEST(QuadironCTest, TestPktSize) // NOLINT
+{
+    struct QuadironFnt32* inst = quadiron_fnt32_new_ex(2, 3, 3, 1, 300);
+    ASSERT_EQ(quadiron_fnt32_get_pkt_size(inst), 300);
+    this->test_all_decodable_scenarios(3, 3, 1, inst);
+    quadiron_fnt32_delete(inst);
+
+    inst = quadiron_fnt32_new_ex(2, 3, 3, 0, QUADIRON_PKT_SIZE_AUTO);
+    ASSERT_GT(quadiron_fnt32_get_pkt_size(inst), 0);
+    this->test_all_decodable_scenarios(3, 3, 0, inst);
+    quadiron_fnt32_delete(inst);
+}
+
+TYPED_TEST(QuadironCTest, TestEncodeBatch) // NOLINT
+{
+    this->test_encode_batch(3, 3, 1);
+    this->test_encode_batch(3, 3, 0);
+}
+
+TYPED_TEST(QuadironCTest, TestUpdate) // NOLINT
+{
+    this->test_update(3, 3, 1);
+    this->test_update(3, 3, 0);
+}
+
+TYPED_TEST(QuadironCTest, TestEncodeOneParity) // NOLINT
+{
+    const int n_data = 3;
+    const int n_parities = 3;
+    const size_t block_size = 8192;
+    struct QuadironFnt32* inst = quadiron_fnt32_new(2, n_data, n_parities, 1);
+    const int metadata_size =
+        quadiron_fnt32_get_metadata_size(inst, block_size);
+    const size_t full_block_size = block_size + metadata_size;
+
+    using Blocks = std::vector<std::vector<uint8_t>>;
+    Blocks data(n_data, std::vector<uint8_t>(full_block_size));
+    Blocks ref_parity(n_parities, std::vector<uint8_t>(full_block_size));
+    std::vector<uint8_t*> _data(n_data);
+    std::vector<uint8_t*> _parity(n_parities);
+    for (int i = 0; i < n_data; i++) {
+        this->randomize_buffer(data[i].data(), full_block_size);
+        _data[i] = data[i].data();
+    }
+    for (int i = 0; i < n_parities; i++) {
+        _parity[i] = ref_parity[i].data();
+    }
+    std::vector<int> wanted_idxs(n_parities, 1);
+    ASSERT_EQ(
+        quadiron_fnt32_encode(
+            inst, _data.data(), _parity.data(), wanted_idxs.data(), block_size),
+        0);
+
+    for (int p = 0; p < n_parities; p++) {
+        std::vector<uint8_t> parity(full_block_size);
+        std::fill(_parity.begin(), _parity.end(), nullptr);
+        _parity[p] = parity.data();
+        std::fill(wanted_idxs.begin(), wanted_idxs.end(), 0);
+        wanted_idxs[p] = 1;
+
+        ASSERT_EQ(
+            quadiron_fnt32_encode(
+                inst,
+                _data.data(),
+                _parity.data(),
+                wanted_idxs.data(),
+                block_size),
+            0);
+        ASSERT_EQ(parity, ref_parity[p]);
+    }
+
+    quadiron_fnt32_delete(inst);
+}
+
+TYPED_TEST(QuadironCTest, TestMetadataFormat) // NOLINT
+{
+    const size_t block_size = 1024 * 1024;
+    struct QuadironFnt32* inst = quadiron_fnt32_new(2, 3, 3, 1);
+    const int fnt1_size = quadiron_fnt32_get_metadata_size(inst, block_size);
+
+    ASSERT_EQ(quadiron_fnt32_set_metadata_format(inst, 0), -1);
+    ASSERT_EQ(
+        quadiron_fnt32_set_metadata_format(inst, QUADIRON_METADATA_FNT2), 0);
+    const int fnt2_size = quadiron_fnt32_get_metadata_size(inst, block_size);
+    ASSERT_LT(fnt2_size, fnt1_size);
+    ASSERT_EQ(fnt2_size % 4, 0);
+    this->test_all_decodable_scenarios(3, 3, 1, inst);
+    quadiron_fnt32_delete(inst);
+
+    inst = quadiron_fnt32_new(2, 3, 3, 0);
+    ASSERT_EQ(
+        quadiron_fnt32_set_metadata_format(inst, QUADIRON_METADATA_FNT2), 0);
+    this->test_all_decodable_scenarios(3, 3, 0, inst);
+    this->test_update(3, 3, 0, inst);
+    quadiron_fnt32_delete(inst);
+}
+
+TYPED_TEST(QuadironCTest, TestStats) // NOLINT
+{
+    struct QuadironFnt32* inst = quadiron_fnt32_new(2, 3, 3, 1);
+    struct QuadironStageStats stats[QUADIRON_N_STAGES];
+    ASSERT_EQ(quadiron_fnt32_get_stats(inst, stats, QUADIRON_N_STAGES), -1);
+
+    quadiron_fnt32_enable_stats(inst, 1);
+    this->test_all_decodable_scenarios(3, 3, 1, inst);
+    ASSERT_EQ(quadiron_fnt32_get_stats(inst, stats, QUADIRON_N_STAGES), 0);
+    ASSERT_GT(stats[QUADIRON_STAGE_PACK].calls, 0);
+    ASSERT_GT(stats[QUADIRON_STAGE_FFT].calls, 0);
+    ASSERT_GT(stats[QUADIRON_STAGE_FFT].cycles, 0);
+    ASSERT_GT(stats[QUADIRON_STAGE_CONTEXT_BUILD].calls, 0);
+
+    quadiron_fnt32_reset_stats(inst);
+    ASSERT_EQ(quadiron_fnt32_get_stats(inst, stats, QUADIRON_N_STAGES), 0);
+    for (unsigned i = 0; i < QUADIRON_N_STAGES; ++i) {
+        ASSERT_EQ(stats[i].calls, 0);
+        ASSERT_EQ(stats[i].cycles, 0);
+    }
+
+    quadiron_fnt32_enable_stats(inst, 0);
+    ASSERT_EQ(quadiron_fnt32_get_stats(inst, stats, QUADIRON_N_STAGES), -1);
+    quadiron_fnt32_delete(inst);
+}
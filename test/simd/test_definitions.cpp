@@ -41,6 +41,7 @@ TEST(SimdDefinitionsTest, TestConstants) // NOLINT
         ASSERT_EQ(simd::REG_BITSZ, 64);
         break;
     case simd::InstructionSet::SSE:
+    case simd::InstructionSet::NEON:
         ASSERT_EQ(simd::ALIGNMENT, 16);
         ASSERT_EQ(simd::REG_BITSZ, 128);
         break;
@@ -48,5 +49,9 @@ TEST(SimdDefinitionsTest, TestConstants) // NOLINT
         ASSERT_EQ(simd::ALIGNMENT, 32);
         ASSERT_EQ(simd::REG_BITSZ, 256);
         break;
+    case simd::InstructionSet::AVX512:
+        ASSERT_EQ(simd::ALIGNMENT, 64);
+        ASSERT_EQ(simd::REG_BITSZ, 512);
+        break;
     }
 }
@@ -0,0 +1,387 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "quadiron.h"
+#include "simd_dispatch.h"
+
+namespace fec = quadiron::fec;
+namespace simd = quadiron::simd;
+namespace vec = quadiron::vec;
+
+namespace {
+
+const std::vector<simd::InstructionSet> ALL_INSTRUCTION_SETS = {
+    simd::InstructionSet::NONE,
+    simd::InstructionSet::SSE,
+    simd::InstructionSet::AVX,
+    simd::InstructionSet::AVX512,
+    simd::InstructionSet::NEON,
+};
+
+} // namespace
+
+class SimdDispatchTest : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        initial = simd::get_instruction_set();
+    }
+
+    void TearDown() override
+    {
+        simd::set_instruction_set(initial);
+    }
+
+    simd::InstructionSet initial;
+};
+
+TEST_F(SimdDispatchTest, TestSelection) // NOLINT
+{
+    ASSERT_TRUE(simd::is_supported(simd::InstructionSet::NONE));
+    ASSERT_TRUE(simd::is_supported(simd::detect_instruction_set()));
+
+    for (simd::InstructionSet instruction_set : ALL_INSTRUCTION_SETS) {
+        if (!simd::is_supported(instruction_set)) {
+            ASSERT_THROW(
+                simd::set_instruction_set(instruction_set),
+                quadiron::InvalidArgument);
+            continue;
+        }
+        simd::set_instruction_set(instruction_set);
+        ASSERT_EQ(simd::get_instruction_set(), instruction_set);
+        if (instruction_set == simd::InstructionSet::NONE) {
+            ASSERT_EQ(simd::get_kernels(), nullptr);
+        } else {
+            ASSERT_NE(simd::get_kernels(), nullptr);
+        }
+    }
+}
+
+template <typename T>
+class SimdDispatchFntTest : public SimdDispatchTest {
+  public:
+    const unsigned n_data = 5;
+    const unsigned n_parities = 3;
+    // Not a multiple of any register size to have trailing elements.
+    const size_t pkt_size = 67;
+
+    // Encode `data` using the kernels of `instruction_set` and check that
+    // every fragment can be decoded back.
+    std::vector<std::vector<uint8_t>> encode_decode(
+        simd::InstructionSet instruction_set,
+        fec::FecType type,
+        std::vector<std::vector<uint8_t>>& data,
+        std::vector<quadiron::Properties>& props)
+    {
+        simd::set_instruction_set(instruction_set);
+        SCOPED_TRACE(simd::get_instruction_set_name(instruction_set));
+
+        const size_t word_size = sizeof(T) / 2;
+        const size_t block_size = data[0].size();
+        fec::RsFnt<T> fec(type, word_size, n_data, n_parities, pkt_size);
+        const unsigned n_outputs = fec.n_outputs;
+
+        std::vector<std::vector<uint8_t>> parities(
+            n_outputs, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> data_bufs(n_data);
+        std::vector<uint8_t*> parities_bufs(n_outputs);
+        for (unsigned i = 0; i < n_data; ++i) {
+            data_bufs[i] = data[i].data();
+        }
+        for (unsigned i = 0; i < n_outputs; ++i) {
+            parities_bufs[i] = parities[i].data();
+        }
+        props.assign(n_outputs, quadiron::Properties());
+        std::vector<bool> wanted_idxs(n_outputs, true);
+
+        fec.encode_blocks_vertical(
+            data_bufs, parities_bufs, props, wanted_idxs, block_size);
+
+        const bool systematic = type == fec::FecType::SYSTEMATIC;
+        const unsigned n_frags = systematic ? n_data + n_outputs : n_outputs;
+        std::vector<int> missing_idxs(n_frags, 0);
+        std::fill_n(missing_idxs.begin(), n_frags - n_data, 1);
+
+        // Available data fragments are read from the output buffers.
+        std::vector<std::vector<uint8_t>> decoded(
+            n_data, std::vector<uint8_t>(block_size));
+        std::vector<uint8_t*> decoded_bufs(n_data);
+        for (unsigned i = 0; i < n_data; ++i) {
+            if (systematic && !missing_idxs[i]) {
+                decoded[i] = data[i];
+            }
+            decoded_bufs[i] = decoded[i].data();
+        }
+        std::vector<bool> wanted_data_idxs(n_data, true);
+
+        EXPECT_TRUE(fec.decode_blocks_vertical(
+            decoded_bufs,
+            parities_bufs,
+            props,
+            missing_idxs,
+            wanted_data_idxs,
+            block_size));
+        for (unsigned i = 0; i < n_data; ++i) {
+            EXPECT_EQ(data[i], decoded[i]);
+        }
+
+        return parities;
+    }
+
+    // Check that every instruction set gives the same result as the scalar
+    // implementation.
+    void run_test(fec::FecType type)
+    {
+        const size_t word_size = sizeof(T) / 2;
+        const size_t block_size = 20 * pkt_size * word_size;
+
+        std::vector<std::vector<uint8_t>> data(
+            n_data, std::vector<uint8_t>(block_size));
+        for (auto& frag : data) {
+            for (auto& byte : frag) {
+                byte = static_cast<uint8_t>(rand());
+            }
+        }
+
+        std::vector<quadiron::Properties> ref_props;
+        const std::vector<std::vector<uint8_t>> ref = encode_decode(
+            simd::InstructionSet::NONE, type, data, ref_props);
+
+        for (simd::InstructionSet instruction_set : ALL_INSTRUCTION_SETS) {
+            if (!simd::is_supported(instruction_set)) {
+                continue;
+            }
+            std::vector<quadiron::Properties> props;
+            ASSERT_EQ(encode_decode(instruction_set, type, data, props), ref);
+            for (size_t i = 0; i < props.size(); ++i) {
+                ASSERT_EQ(props[i].get_map(), ref_props[i].get_map());
+            }
+        }
+    }
+};
+
+using FntTypes = ::testing::Types<uint16_t, uint32_t>;
+TYPED_TEST_CASE(SimdDispatchFntTest, FntTypes);
+
+TYPED_TEST(SimdDispatchFntTest, TestSameResults) // NOLINT
+{
+    this->run_test(fec::FecType::NON_SYSTEMATIC);
+    this->run_test(fec::FecType::SYSTEMATIC);
+}
+
+TYPED_TEST(SimdDispatchFntTest, TestRingSameResults) // NOLINT
+{
+    using Buffer = std::vector<TypeParam, simd::AlignedAllocator<TypeParam>>;
+
+    const TypeParam card = sizeof(TypeParam) == 2 ? 257 : 65537;
+    auto gf(quadiron::gf::create<quadiron::gf::Prime<TypeParam>>(card));
+    // Not a multiple of any register size to have trailing elements.
+    const size_t len = 67;
+
+    Buffer x(len);
+    Buffer y(len);
+    for (size_t i = 0; i < len; ++i) {
+        x[i] = gf.rand();
+        y[i] = gf.rand();
+    }
+    // Overflow cases of the modular multiplication.
+    x[len - 1] = card - 1;
+    y[len - 1] = card - 1;
+
+    std::vector<Buffer> ref;
+    for (simd::InstructionSet instruction_set : ALL_INSTRUCTION_SETS) {
+        if (!simd::is_supported(instruction_set)) {
+            continue;
+        }
+        simd::set_instruction_set(instruction_set);
+        SCOPED_TRACE(simd::get_instruction_set_name(instruction_set));
+
+        std::vector<Buffer> results(5, Buffer(len));
+        gf.mul_coef_to_buf(3, x.data(), results[0].data(), len);
+        results[1] = y;
+        gf.add_two_bufs(x.data(), results[1].data(), len);
+        gf.sub_two_bufs(x.data(), y.data(), results[2].data(), len);
+        results[3] = x;
+        gf.hadamard_mul(len, results[3].data(), y.data());
+        results[4] = x;
+        gf.neg(len, results[4].data());
+
+        if (ref.empty()) {
+            ref = results;
+        } else {
+            ASSERT_EQ(results, ref);
+        }
+    }
+}
+
+TYPED_TEST(SimdDispatchFntTest, TestGf2nSameResults) // NOLINT
+{
+    using Buffer = std::vector<TypeParam, simd::AlignedAllocator<TypeParam>>;
+
+    // Not a multiple of any register size to have trailing elements.
+    const size_t len = 67;
+
+    for (unsigned n = 8; n < 8 * sizeof(TypeParam); n *= 2) {
+        auto gf(quadiron::gf::create<quadiron::gf::BinExtension<TypeParam>>(n));
+        const TypeParam max = gf.card() - 1;
+
+        Buffer x(len);
+        Buffer y(len);
+        for (size_t i = 0; i < len; ++i) {
+            x[i] = gf.rand();
+            y[i] = gf.rand();
+        }
+        x[0] = 0;
+        x[len - 1] = max;
+
+        for (simd::InstructionSet instruction_set : ALL_INSTRUCTION_SETS) {
+            if (!simd::is_supported(instruction_set)) {
+                continue;
+            }
+            simd::set_instruction_set(instruction_set);
+            SCOPED_TRACE(simd::get_instruction_set_name(instruction_set));
+
+            for (const TypeParam a : {TypeParam(2), TypeParam(0x53), max}) {
+                Buffer res(len);
+                gf.mul_coef_to_buf(a, x.data(), res.data(), len);
+                for (size_t i = 0; i < len; ++i) {
+                    ASSERT_EQ(res[i], gf.mul(a, x[i]));
+                }
+                Buffer acc = y;
+                gf.mul_coef_add_to_buf(a, x.data(), acc.data(), len);
+                for (size_t i = 0; i < len; ++i) {
+                    ASSERT_EQ(acc[i], gf.add(y[i], gf.mul(a, x[i])));
+                }
+            }
+
+            Buffer sum = y;
+            Buffer diff(len);
+            gf.add_two_bufs(x.data(), sum.data(), len);
+            gf.sub_two_bufs(x.data(), y.data(), diff.data(), len);
+            for (size_t i = 0; i < len; ++i) {
+                ASSERT_EQ(sum[i], gf.add(x[i], y[i]));
+                ASSERT_EQ(diff[i], gf.sub(x[i], y[i]));
+            }
+        }
+    }
+}
+
+TYPED_TEST(SimdDispatchFntTest, TestFftSameResults) // NOLINT
+{
+    const TypeParam card = sizeof(TypeParam) == 2 ? 257 : 65537;
+    auto gf(quadiron::gf::create<quadiron::gf::Prime<TypeParam>>(card));
+    const size_t size = this->pkt_size;
+
+    // Both an even and an odd number of layers.
+    for (const unsigned n : {64, 128}) {
+        vec::Buffers<TypeParam> input(n, size);
+        for (unsigned i = 0; i < n; ++i) {
+            TypeParam* mem = input.get(i);
+            for (size_t u = 0; u < size; ++u) {
+                mem[u] = gf.rand();
+            }
+        }
+        // Overflow case of the modular operations.
+        input.get(n - 1)[size - 1] = card - 1;
+
+        std::vector<std::vector<TypeParam>> ref;
+        for (simd::InstructionSet instruction_set : ALL_INSTRUCTION_SETS) {
+            if (!simd::is_supported(instruction_set)) {
+                continue;
+            }
+            simd::set_instruction_set(instruction_set);
+            SCOPED_TRACE(simd::get_instruction_set_name(instruction_set));
+
+            quadiron::fft::Radix2<TypeParam> fft(gf, n, n, size);
+            vec::Buffers<TypeParam> output(n, size);
+            vec::Buffers<TypeParam> back(n, size);
+            std::vector<std::vector<TypeParam>> results;
+
+            fft.fft(output, input);
+            fft.ifft(back, output);
+            ASSERT_EQ(back, input);
+            for (unsigned i = 0; i < n; ++i) {
+                results.emplace_back(output.get(i), output.get(i) + size);
+            }
+            fft.fft_inv(output, input);
+            for (unsigned i = 0; i < n; ++i) {
+                results.emplace_back(output.get(i), output.get(i) + size);
+            }
+
+            if (ref.empty()) {
+                ref = results;
+            } else {
+                ASSERT_EQ(results, ref);
+            }
+        }
+    }
+}
+
+TEST_F(SimdDispatchTest, TestNf4SameResults) // NOLINT
+{
+    const unsigned n_data = 3;
+    const unsigned n_parities = 3;
+    const unsigned word_size = 4;
+    std::vector<__uint128_t> data;
+    std::vector<__uint128_t> ref;
+
+    for (simd::InstructionSet instruction_set : ALL_INSTRUCTION_SETS) {
+        if (!simd::is_supported(instruction_set)) {
+            continue;
+        }
+        simd::set_instruction_set(instruction_set);
+
+        fec::RsNf4<__uint128_t> fec(word_size, n_data, n_parities);
+        const quadiron::gf::NF4<__uint128_t>& nf4 =
+            static_cast<const quadiron::gf::NF4<__uint128_t>&>(fec.get_gf());
+        vec::Vector<__uint128_t> data_frags(nf4, n_data);
+        vec::Vector<__uint128_t> encoded_frags(nf4, fec.n);
+        std::vector<quadiron::Properties> props(fec.n);
+
+        for (unsigned i = 0; i < n_data; ++i) {
+            if (data.size() < n_data) {
+                data.push_back(nf4.unpacked_rand());
+            }
+            data_frags.set(i, data[i]);
+        }
+        fec.encode(encoded_frags, props, 0, data_frags);
+
+        const std::vector<__uint128_t> encoded(
+            encoded_frags.get_mem(), encoded_frags.get_mem() + fec.n);
+        if (ref.empty()) {
+            ref = encoded;
+        } else {
+            ASSERT_EQ(encoded, ref);
+        }
+    }
+}
@@ -44,11 +44,15 @@ TEST(SimdTest, TestCountOf) // NOLINT
         expected = {1, 1, 1, 1};
         break;
     case simd::InstructionSet::SSE:
+    case simd::InstructionSet::NEON:
         expected = {16, 8, 4, 2};
         break;
     case simd::InstructionSet::AVX:
         expected = {32, 16, 8, 4};
         break;
+    case simd::InstructionSet::AVX512:
+        expected = {64, 32, 16, 8};
+        break;
     }
 
     ASSERT_EQ(simd::countof<uint8_t>(), expected[0]);